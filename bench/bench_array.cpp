@@ -0,0 +1,64 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+#include "json_stream.hpp"
+#include "json_document.hpp"
+
+using jslite::Json;
+
+static std::string make_numbers(size_t count) {
+    std::string text("[");
+    for (size_t i = 0; i < count; ++i) {
+        if (i) text += ",";
+        text += std::to_string(i * 7919 % 1000003);
+    }
+    return text + "]";
+}
+
+static std::string make_records(size_t count) {
+    std::string text("[");
+    for (size_t i = 0; i < count; ++i) {
+        if (i) text += ",";
+        text += "{\"id\":" + std::to_string(i) + ",\"tags\":[1,2,3,4],\"name\":\"record\"}";
+    }
+    return text + "]";
+}
+
+static void bench(const char* name, const std::string& text, uint32_t flags) {
+    char label[64];
+    jslite::JsonStream parser;
+    parser.set_parse_flags(flags);
+    parser << text;
+
+    Json json;
+    Stopwatch sw;
+    parser.Parse(json);
+    snprintf(label, sizeof(label), "%s, heap", name);
+    REPORT_BYTES(label, (double)text.size(), sw.seconds());
+
+    sw.reset();
+    size_t total = 0;
+    for (size_t i = 0; i < json.size(); ++i) total += json[i].size();
+    snprintf(label, sizeof(label), "%s, walk by index", name);
+    REPORT(label, (double)json.size(), sw.seconds());
+    keep(total);
+
+    jslite::JsonDocument doc;
+    sw.reset();
+    parser.Parse(doc);
+    snprintf(label, sizeof(label), "%s, document", name);
+    REPORT_BYTES(label, (double)text.size(), sw.seconds());
+    printf("    arena %zu bytes\n", doc.used());
+}
+
+int main() {
+    const std::string numbers = make_numbers(2000000);
+    const std::string records = make_records(200000);
+
+    bench("numbers", numbers, jslite::PARSE_DEFAULT);
+    bench("numbers presized", numbers, jslite::PARSE_PRESIZE_ARRAYS);
+    bench("numbers lazy", numbers, jslite::PARSE_PRESIZE_ARRAYS | jslite::PARSE_LAZY_NUMBERS);
+    bench("records", records, jslite::PARSE_DEFAULT);
+    bench("records presized", records, jslite::PARSE_PRESIZE_ARRAYS);
+
+    return 0;
+}
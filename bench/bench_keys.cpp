@@ -0,0 +1,51 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+#include "json_stream.hpp"
+#include "json_document.hpp"
+
+using jslite::Json;
+
+static std::string make_records(size_t count) {
+    std::string text("[");
+    for (size_t i = 0; i < count; ++i) {
+        if (i) text += ",";
+        text += "{\"id\":" + std::to_string(i) + ",\"name\":\"user\",\"status\":\"active\",\"created_at\":1420000000,"
+                "\"enabled\":true,\"description_of_the_record\":\"\",\"owner\":null,\"version\":3}";
+    }
+    return text + "]";
+}
+
+static void bench(const char* name, const std::string& text, jslite::JsonKeyPool& pool) {
+    jslite::JsonStream parser;
+    parser.set_key_pool(&pool);
+    parser << text;
+
+    Json json;
+    Stopwatch sw;
+    parser.Parse(json);
+    REPORT_BYTES(name, (double)text.size(), sw.seconds());
+    printf("    keys %zu, lookups %zu, hit rate %.3f, saved %zu bytes\n",
+           pool.size(), pool.lookups(), pool.hit_rate(), pool.saved());
+    keep(json);
+}
+
+int main() {
+    const std::string text = make_records(200000);
+
+    jslite::JsonKeyPool none(NULL, 0);
+    bench("parse, keys not interned", text, none);
+
+    jslite::JsonKeyPool pool;
+    bench("parse, interned keys", text, pool);
+
+    jslite::JsonDocument doc;
+    jslite::JsonStream parser;
+    parser << text;
+    Stopwatch sw;
+    parser.Parse(doc);
+    REPORT_BYTES("parse into JsonDocument", (double)text.size(), sw.seconds());
+    printf("    keys %zu, hit rate %.3f, saved %zu bytes, arena %zu bytes\n",
+           doc.keys().size(), doc.keys().hit_rate(), doc.keys().saved(), doc.used());
+
+    return 0;
+}
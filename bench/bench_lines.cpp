@@ -0,0 +1,88 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+#include "json_document.hpp"
+#include "json_lines.hpp"
+
+#include <stdlib.h>
+
+using jslite::Json;
+using jslite::JsonLineReader;
+using jslite::JsonLineWriter;
+
+static const char *levels[] = { "debug", "info", "warn", "error" };
+static const char *services[] = { "api", "auth", "billing", "search", "gateway" };
+
+// records of a service log
+static Json make_record(int i) {
+    Json record;
+    record["ts"] = (Json::Integer)(1420070400000LL + i * 37);
+    record["level"] = levels[rand() % 4];
+    record["service"] = services[rand() % 5];
+    record["msg"] = "request " + std::to_string(i) + " finished with \"status\" " + std::to_string(200 + rand() % 300);
+    record["latency_ms"] = rand() / (double)RAND_MAX * 250.0;
+    record["ok"] = (0 != rand() % 10);
+    Json &tags = (record["tags"] = Json::Array());
+    for (int t = rand() % 4; t > 0; --t) tags.put("tag" + std::to_string(rand() % 20));
+    return record;
+}
+
+// counts values without building them
+struct Counter : public jslite::JsonHandler {
+    Counter() : values(0) {}
+    bool Null() { ++values; return true; }
+    bool Boolean(bool) { ++values; return true; }
+    bool Integer(int64_t) { ++values; return true; }
+    bool Real(double) { ++values; return true; }
+    bool String(const jslite::StringRef&) { ++values; return true; }
+    size_t values;
+};
+
+template <class Target>
+static void bench_read(const char* name, const std::string& text, size_t count, Target& target) {
+    JsonLineReader reader;
+    Stopwatch sw;
+    reader.Reset(text);
+    while (jslite::LINES_END != reader.Next(target)) {}
+    const double secs = sw.seconds();
+    std::string label(name);
+    REPORT((label + ", records").c_str(), (double)count, secs);
+    REPORT_BYTES(label.c_str(), (double)text.size(), secs);
+    keep(target);
+}
+
+int main() {
+    const size_t count = 500000;
+    srand(20);
+    std::vector<Json> records;
+    for (size_t i = 0; i < count; ++i) records.push_back(make_record((int)i));
+
+    JsonLineWriter writer;
+    Stopwatch sw;
+    for (size_t i = 0; i < count; ++i) writer.Write(records[i]);
+    double secs = sw.seconds();
+    REPORT("write, records", (double)count, secs);
+    REPORT_BYTES("write", (double)writer.size(), secs);
+    const std::string text = writer.str();
+
+    Json json;
+    bench_read("read into a json", text, count, json);
+    jslite::JsonDocument doc;
+    bench_read("read into a document", text, count, doc);
+    Counter counter;
+    bench_read("read into a handler", text, count, counter);
+
+    // chunks as they come from a socket
+    JsonLineReader reader;
+    sw.reset();
+    for (size_t pos = 0; pos < text.size(); pos += 64 * 1024) {
+        reader.Feed(text.data() + pos, std::min((size_t)64 * 1024, text.size() - pos));
+        while (0 == reader.Next(doc)) {}
+    }
+    reader.Finish();
+    while (jslite::LINES_END != reader.Next(doc)) {}
+    secs = sw.seconds();
+    REPORT("read 64 KB chunks, records", (double)reader.records(), secs);
+    REPORT_BYTES("read 64 KB chunks", (double)text.size(), secs);
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+#include "json_stream.hpp"
+
+#include <stdlib.h>
+
+using jslite::Json;
+
+// polygons of longitude and latitude pairs, like a geojson file
+static std::string make_coordinates(size_t count) {
+    std::string text("[");
+    char buf[64];
+    srand(7);
+    for (size_t i = 0; i < count; ++i) {
+        double lon = rand() * 360.0 / RAND_MAX - 180.0, lat = rand() * 180.0 / RAND_MAX - 90.0;
+        snprintf(buf, sizeof(buf), "%s[%.15g,%.15g]", (i ? "," : ""), lon, lat);
+        text += buf;
+    }
+    return text + "]";
+}
+
+static std::string make_integers(size_t count) {
+    std::string text("[");
+    for (size_t i = 0; i < count; ++i) {
+        if (i) text += ",";
+        text += std::to_string((long long)(i * 2654435761ULL % 100000000000ULL) - 50000000000LL);
+    }
+    return text + "]";
+}
+
+static void bench(const char* name, const std::string& text, uint32_t flags) {
+    jslite::JsonStream parser;
+    parser.set_parse_flags(flags);
+    parser << text;
+
+    Json json;
+    Stopwatch sw;
+    parser.Parse(json);
+    REPORT_BYTES(name, (double)text.size(), sw.seconds());
+    keep(json);
+}
+
+int main() {
+    const std::string coordinates = make_coordinates(1000000);
+    const std::string integers = make_integers(2000000);
+
+    bench("coordinates", coordinates, jslite::PARSE_PRESIZE_ARRAYS);
+    bench("integers", integers, jslite::PARSE_PRESIZE_ARRAYS);
+
+    // the conversion alone, without building values
+    jslite::JsonStream parser;
+    parser << coordinates;
+    Json json;
+    parser.set_parse_flags(jslite::PARSE_PRESIZE_ARRAYS | jslite::PARSE_LAZY_NUMBERS);
+    parser.Parse(json);
+
+    Stopwatch sw;
+    double sum = 0.0;
+    for (size_t i = 0; i < json.size(); ++i) sum += json[i][0].real() + json[i][1].real();
+    REPORT("convert lazy reals", 2.0 * json.size(), sw.seconds());
+    keep(sum);
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+
+#include <map>
+#include <vector>
+
+using jslite::Json;
+
+typedef std::map<std::string, Json> MapObject;
+
+static std::vector<std::string> make_keys(size_t count) {
+    static const char *names[] = {
+        "id", "name", "type", "status", "created_at", "updated_at", "user", "value",
+        "tags", "count", "enabled", "description", "url", "version", "parent", "owner"
+    };
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < count; ++i) {
+        std::string key(names[i % 16]);
+        if (i >= 16) key += "_" + std::to_string(i / 16);
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+static void bench(size_t size) {
+    const std::vector<std::string> keys = make_keys(size);
+    const size_t rounds = 2000000 / size;
+    char name[64];
+
+    Stopwatch sw;
+    for (size_t r = 0; r < rounds; ++r) {
+        MapObject obj;
+        for (size_t i = 0; i < size; ++i) obj[keys[i]] = (Json::Integer)i;
+        keep(obj);
+    }
+    snprintf(name, sizeof(name), "insert std::map      (%zu keys)", size);
+    REPORT(name, (double)rounds * size, sw.seconds());
+
+    sw.reset();
+    for (size_t r = 0; r < rounds; ++r) {
+        Json::Object obj;
+        for (size_t i = 0; i < size; ++i) obj[keys[i]] = (Json::Integer)i;
+        keep(obj);
+    }
+    snprintf(name, sizeof(name), "insert Json::Object  (%zu keys)", size);
+    REPORT(name, (double)rounds * size, sw.seconds());
+
+    MapObject map_obj;
+    Json::Object flat_obj;
+    for (size_t i = 0; i < size; ++i) {
+        map_obj[keys[i]] = (Json::Integer)i;
+        flat_obj[keys[i]] = (Json::Integer)i;
+    }
+
+    Json::Integer sum = 0;
+    sw.reset();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < size; ++i) sum += map_obj.find(keys[i])->second.integer();
+    }
+    snprintf(name, sizeof(name), "lookup std::map      (%zu keys)", size);
+    REPORT(name, (double)rounds * size, sw.seconds());
+
+    sw.reset();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < size; ++i) sum += flat_obj.find(keys[i])->second.integer();
+    }
+    snprintf(name, sizeof(name), "lookup Json::Object  (%zu keys)", size);
+    REPORT(name, (double)rounds * size, sw.seconds());
+
+    keep(sum);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t sizes[] = { 4, 8, 16, 32, 128, 1024 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) bench(sizes[i]);
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+#include "json_document.hpp"
+#include "json_lines.hpp"
+#include "json_parallel.hpp"
+#include "json_stream.hpp"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <thread>
+
+using jslite::Json;
+using jslite::JsonLineBatch;
+using jslite::JsonParallelReader;
+
+static const char *levels[] = { "debug", "info", "warn", "error" };
+
+// lines of a service log
+static std::string make_text(size_t count) {
+    jslite::JsonLineWriter writer;
+    for (size_t i = 0; i < count; ++i) {
+        Json record;
+        record["ts"] = (Json::Integer)(1420070400000LL + i * 37);
+        record["level"] = levels[rand() % 4];
+        record["msg"] = "request " + std::to_string(i) + " finished with \"status\" " + std::to_string(200 + rand() % 300);
+        record["latency_ms"] = rand() % 25000 / 100.0;
+        record["ok"] = (0 != rand() % 10);
+        Json &tags = (record["tags"] = Json::Array());
+        for (int t = rand() % 4; t > 0; --t) tags.put("tag" + std::to_string(rand() % 20));
+        writer.Write(record);
+    }
+    return writer.str();
+}
+
+static void bench_parallel(const std::string& text, size_t threads, jslite::BatchOrder order) {
+    JsonParallelReader reader(threads);
+    reader.set_order(order);
+    Stopwatch sw;
+    reader.Reset(text);
+    size_t values = 0;
+    while (const JsonLineBatch *batch = reader.Next()) values += batch->size();
+    const double secs = sw.seconds();
+    keep(values);
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s, %zu threads", (jslite::ORDER_INPUT == order ? "in order" : "any order"), threads);
+    REPORT((std::string(name) + ", records").c_str(), (double)reader.records(), secs);
+    REPORT_BYTES(name, (double)text.size(), secs);
+}
+
+// one array of all the records
+static void bench_array(const std::string& text, size_t threads) {
+    jslite::JsonParallelParser parser(threads);
+    Json json;
+    Stopwatch sw;
+    parser.Parse(text, json);
+    const double secs = sw.seconds();
+
+    char name[64];
+    snprintf(name, sizeof(name), "array, %zu threads", threads);
+    REPORT((std::string(name) + ", records").c_str(), (double)json.size(), secs);
+    REPORT_BYTES(name, (double)text.size(), secs);
+}
+
+int main() {
+    const size_t count = 1000000;
+    srand(21);
+    const std::string text = make_text(count);
+
+    // one thread without a pool
+    jslite::JsonLineReader lines;
+    jslite::JsonDocument doc;
+    Stopwatch sw;
+    lines.Reset(text);
+    while (jslite::LINES_END != lines.Next(doc)) {}
+    const double secs = sw.seconds();
+    REPORT("line reader, records", (double)lines.records(), secs);
+    REPORT_BYTES("line reader", (double)text.size(), secs);
+
+    const size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    printf("%u cores\n", (unsigned)cores);
+    for (size_t threads = 1; threads <= std::max(cores, (size_t)4); threads *= 2) {
+        bench_parallel(text, threads, jslite::ORDER_INPUT);
+        bench_parallel(text, threads, jslite::ORDER_ANY);
+    }
+
+    std::string array = "[" + text + "]";
+    std::replace(array.begin(), array.end(), '\n', ',');
+    array[array.size() - 2] = ' ';
+
+    jslite::JsonStream stream;
+    Json json;
+    sw.reset();
+    stream.Parse(array, json);
+    const double stream_secs = sw.seconds();
+    REPORT("array, stream, records", (double)json.size(), stream_secs);
+    REPORT_BYTES("array, stream", (double)array.size(), stream_secs);
+    json.clear();
+
+    for (size_t threads = 1; threads <= std::max(cores, (size_t)4); threads *= 2) bench_array(array, threads);
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+#include "json_document.hpp"
+#include "json_projection.hpp"
+#include "json_stream.hpp"
+
+#include <stdlib.h>
+#include <string>
+
+using jslite::Json;
+using jslite::JsonProjection;
+using jslite::JsonStream;
+
+// a record with hundreds of members, of which a few are needed
+static std::string make_record() {
+    std::string text = "{\"user\":{\"id\":12345,\"name\":\"some user\",\"email\":\"user@example.com\"},";
+    for (int i = 0; i < 300; ++i) {
+        text += "\"field" + std::to_string(i) + "\":";
+        switch(i % 5) {
+        case 0: text += std::to_string(rand()); break;
+        case 1: text += std::to_string(rand() / 7.0); break;
+        case 2: text += "\"text with \\\"escapes\\\" and \\u00e9 " + std::to_string(i) + "\""; break;
+        case 3: text += "[1,2,3,{\"a\":\"b\"},[true,false,null]]"; break;
+        default: text += "{\"x\":" + std::to_string(i) + ",\"y\":\"" + std::string(40, 'y') + "\"}"; break;
+        }
+        text += ",";
+    }
+    text += "\"events\":[";
+    for (int i = 0; i < 20; ++i) {
+        if (i) text += ",";
+        text += "{\"ts\":" + std::to_string(1420070400 + i) + ",\"kind\":\"click\",\"data\":{\"path\":\"/a/b/c\",\"n\":" + std::to_string(i) + "}}";
+    }
+    text += "]}";
+    return text;
+}
+
+static void bench(const char* name, const std::string& text, const JsonProjection* projection, int count) {
+    JsonStream stream;
+    stream.set_projection(projection);
+    jslite::JsonDocument doc;
+    Stopwatch sw;
+    for (int i = 0; i < count; ++i) stream.Parse(text, doc);
+    const double secs = sw.seconds();
+    keep(doc.root());
+
+    REPORT((std::string(name) + ", records").c_str(), (double)count, secs);
+    REPORT_BYTES(name, (double)text.size() * count, secs);
+}
+
+int main() {
+    srand(23);
+    const std::string text = make_record();
+    const int count = 20000;
+    printf("%zu bytes a record\n", text.size());
+
+    bench("all members", text, NULL, count);
+
+    JsonProjection projection;
+    projection.Add("/user/id");
+    projection.Add("/user/name");
+    projection.Add("/field7");
+    projection.Add("/field150");
+    projection.Add("/events/*/ts");
+    bench("5 paths", text, &projection, count);
+
+    projection.clear();
+    projection.Add("/user/id");
+    bench("1 path", text, &projection, count);
+
+    return 0;
+}
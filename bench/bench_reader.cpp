@@ -0,0 +1,76 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+#include "json_reader.hpp"
+#include "json_stream.hpp"
+
+using jslite::Json;
+using jslite::JsonReader;
+using jslite::JsonTokenzier;
+using jslite::StringRef;
+
+// messages with a few fields a decoder wants among others it does not
+static std::string make_message(int i) {
+    return "{\"id\":" + std::to_string(i) + ",\"source\":\"gateway-" + std::to_string(i % 7) +
+           "\",\"tags\":[\"a\",\"b\",{\"c\":[1,2,3]}],\"price\":" + std::to_string(i * 0.25) +
+           ",\"meta\":{\"host\":\"h1\",\"pid\":1234,\"ok\":true},\"open\":" + (i % 2 ? "true" : "false") + "}";
+}
+
+struct Order {
+    int64_t id;
+    double  price;
+    bool    open;
+};
+
+static bool decode(const std::string& text, Order& order) {
+    JsonReader reader(text);
+    if (JsonTokenzier::TK_OBJ_BEGIN != reader.NextToken()) return false;
+
+    StringRef key;
+    int32_t ret = 0;
+    while (JsonTokenzier::TK_STRING == reader.NextToken()) {
+        reader.GetStringView(key);
+        reader.NextToken();
+        reader.NextToken();
+        if (key == "id") ret = reader.GetInt64(order.id);
+        else if (key == "price") ret = reader.GetDouble(order.price);
+        else if (key == "open") ret = reader.GetBool(order.open);
+        else ret = reader.SkipValue();
+        if (0 != ret) return false;
+        if (JsonTokenzier::TK_COMMA != reader.NextToken()) break;
+    }
+    return true;
+}
+
+int main() {
+    const int count = 200000;
+    std::vector<std::string> messages;
+    size_t bytes = 0;
+    for (int i = 0; i < count; ++i) {
+        messages.push_back(make_message(i));
+        bytes += messages.back().size();
+    }
+
+    Order order;
+    double sum = 0.0;
+    Stopwatch sw;
+    for (int i = 0; i < count; ++i) {
+        decode(messages[i], order);
+        sum += order.id + order.price + order.open;
+    }
+    REPORT_BYTES("reader, three fields", (double)bytes, sw.seconds());
+    keep(sum);
+
+    sum = 0.0;
+    sw.reset();
+    for (int i = 0; i < count; ++i) {
+        jslite::JsonStream parser;
+        parser << messages[i];
+        Json json;
+        parser.Parse(json);
+        sum += json["id"].integer() + json["price"].real() + json["open"].boolean();
+    }
+    REPORT_BYTES("tree, three fields", (double)bytes, sw.seconds());
+    keep(sum);
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+#include "json_document.hpp"
+#include "json_sax.hpp"
+#include "json_stream.hpp"
+
+#include <stdlib.h>
+#include <new>
+#include <string>
+#include <vector>
+
+// heap allocations, counted for the parse of each message
+static size_t news = 0;
+
+void* operator new(size_t size) {
+    ++news;
+    void *p = malloc(size ? size : 1);
+    if (NULL == p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+using jslite::Json;
+using jslite::JsonDocument;
+using jslite::JsonStream;
+
+// a small request of the same shape each time, as a service gets them
+static std::string make_message(int i) {
+    return "{\"id\":" + std::to_string(i) + ",\"method\":\"order.update\",\"user\":{\"name\":\"user \\\"" +
+           std::to_string(i % 100) + "\\\"\",\"roles\":[\"a\",\"b\"]},\"items\":[{\"sku\":\"x-1\",\"qty\":2,\"price\":9.5},"
+           "{\"sku\":\"y-2\",\"qty\":1,\"price\":120.25}],\"meta\":{\"trace\":\"0af7651916cd43dd8448eb211c80319c\"}}";
+}
+
+static void report(const char* name, const std::vector<std::string>& msgs, size_t before, double secs) {
+    REPORT(name, (double)msgs.size(), secs);
+    printf("    %.1f allocations a message\n", (double)(news - before) / msgs.size());
+}
+
+int main() {
+    std::vector<std::string> msgs;
+    for (int i = 0; i < 500000; ++i) msgs.push_back(make_message(i));
+
+    {
+        size_t before = news;
+        Stopwatch sw;
+        for (size_t i = 0; i < msgs.size(); ++i) {
+            JsonStream stream;
+            JsonDocument doc;
+            stream.Parse(msgs[i], doc);
+            keep(doc.root());
+        }
+        report("new stream and document", msgs, before, sw.seconds());
+    }
+
+    JsonStream stream;
+    {
+        Json json;
+        stream.Parse(msgs[0], json);
+        size_t before = news;
+        Stopwatch sw;
+        for (size_t i = 0; i < msgs.size(); ++i) {
+            Json json;
+            stream.Parse(msgs[i], json);
+            keep(json);
+        }
+        report("one stream, heap values", msgs, before, sw.seconds());
+    }
+    {
+        JsonDocument doc;
+        stream.Parse(msgs[0], doc);
+        size_t before = news;
+        Stopwatch sw;
+        for (size_t i = 0; i < msgs.size(); ++i) stream.Parse(msgs[i], doc);
+        keep(doc.root());
+        report("one stream, one document", msgs, before, sw.seconds());
+    }
+    {
+        jslite::JsonHandler handler;
+        stream.Parse(msgs[0], handler);
+        size_t before = news;
+        Stopwatch sw;
+        for (size_t i = 0; i < msgs.size(); ++i) stream.Parse(msgs[i], handler);
+        report("one stream, handler", msgs, before, sw.seconds());
+    }
+
+    return 0;
+}
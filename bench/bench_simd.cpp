@@ -0,0 +1,84 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+#include "json_simd.hpp"
+#include "json_stream.hpp"
+
+using jslite::Json;
+
+static std::string make_records(size_t count) {
+    std::string text("[");
+    for (size_t i = 0; i < count; ++i) {
+        if (i) text += ",\n  ";
+        text += "{\"id\": " + std::to_string(i) + ", \"name\": \"user \\\"" + std::to_string(i) + "\\\"\","
+                " \"score\": 12.5, \"tags\": [\"a\", \"b\", \"c\"], \"enabled\": true,"
+                " \"description\": \"a longer text field that spans most of one block\"}";
+    }
+    return text + "]";
+}
+
+// long string values, like base64 blobs or embedded html
+static std::string make_blobs(size_t count) {
+    std::string text("[");
+    for (size_t i = 0; i < count; ++i) {
+        if (i) text += ",";
+        text += "{\"id\":" + std::to_string(i) + ",\"data\":\"";
+        for (size_t j = 0; j < 2048; ++j) text += "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[(i + j * 7) % 64];
+        text += "\",\"html\":\"<div class=\\\"item\\\">a paragraph of text in an item</div>\"}";
+    }
+    return text + "]";
+}
+
+// pretty printed with deep indentation
+static std::string make_pretty(size_t count) {
+    std::string text("{\n    \"items\": [\n");
+    for (size_t i = 0; i < count; ++i) {
+        if (i) text += ",\n";
+        text += "        {\n            \"id\": " + std::to_string(i) + ",\n"
+                "            \"values\": [\n                1,\n                2,\n                3\n            ],\n"
+                "            \"name\": \"item\"\n        }";
+    }
+    return text + "\n    ]\n}\n";
+}
+
+static void bench_index(const char* name, const std::string& text, jslite::SimdLevel level) {
+    jslite::JsonStructuralIndex index;
+    index.Build(text.c_str(), text.c_str() + text.size(), level);
+
+    Stopwatch sw;
+    for (int i = 0; i < 10; ++i) index.Build(text.c_str(), text.c_str() + text.size(), level);
+    REPORT_BYTES(name, 10.0 * text.size(), sw.seconds());
+    printf("    %zu positions\n", index.size());
+}
+
+static void bench_parse(const char* name, const std::string& text, uint32_t flags) {
+    jslite::JsonStream parser;
+    parser.set_parse_flags(flags);
+    parser << text;
+
+    Json json;
+    Stopwatch sw;
+    parser.Parse(json);
+    REPORT_BYTES(name, (double)text.size(), sw.seconds());
+    keep(json);
+}
+
+int main() {
+    const std::string text = make_records(200000);
+    printf("simd level %d\n", jslite::simd_level());
+
+    bench_index("index, scalar", text, jslite::SIMD_SCALAR);
+    if (jslite::simd_level() >= jslite::SIMD_SSE2) bench_index("index, sse2", text, jslite::SIMD_SSE2);
+    if (jslite::simd_level() >= jslite::SIMD_AVX2) bench_index("index, avx2", text, jslite::SIMD_AVX2);
+
+    bench_parse("parse", text, jslite::PARSE_DEFAULT);
+    bench_parse("parse, structural index", text, jslite::PARSE_STRUCTURAL_INDEX);
+
+    const std::string blobs = make_blobs(20000);
+    bench_parse("parse long strings", blobs, jslite::PARSE_DEFAULT);
+    bench_parse("parse long strings, zero copy", blobs, jslite::PARSE_ZERO_COPY);
+
+    const std::string pretty = make_pretty(200000);
+    bench_parse("parse pretty printed", pretty, jslite::PARSE_DEFAULT);
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "jbench.hpp"
+#include "jsonlite.hpp"
+#include "json_simd.hpp"
+#include "json_tokenizer.hpp"
+
+#include <string>
+
+using jslite::JsonTokenzier;
+
+// members of long strings with escapes, as text or html fields are
+static std::string make_strings(size_t count) {
+    std::string text("{\"records\":[");
+    for (size_t i = 0; i < count; ++i) {
+        if (i) text += ",";
+        text += "{\"id\":" + std::to_string(i) + ",\"title\":\"a title with \\\"quotes\\\" and [brackets]\","
+                "\"body\":\"<p class=\\\"text\\\">" + std::string(300, 'x') + "</p>\\n<p>{" + std::string(200, 'y') + "}</p>\","
+                "\"tags\":[\"one\",\"two\",\"three\"]}";
+    }
+    return text + "]}";
+}
+
+// containers nested thousands of levels, with a few values in each
+static std::string make_nested(size_t depth) {
+    std::string text;
+    for (size_t i = 0; i < depth; ++i) text += (i % 2 ? "[1,\"a\"," : "{\"k\":\"value\",\"v\":");
+    text += "null";
+    for (size_t i = depth; i > 0; --i) text += (i % 2 ? "}" : "]");
+    return text;
+}
+
+// what a skip was before: every token of the value read and dropped
+static bool skip_tokens(JsonTokenzier& tokenizer) {
+    for (size_t depth = 1; depth > 0;) {
+        switch(tokenizer.SkipCommentAndNextToken().type) {
+        case JsonTokenzier::TK_OBJ_BEGIN: case JsonTokenzier::TK_ARR_BEGIN: ++depth; break;
+        case JsonTokenzier::TK_OBJ_END: case JsonTokenzier::TK_ARR_END: --depth; break;
+        case JsonTokenzier::TK_EOF: case JsonTokenzier::TK_WRONG: return false;
+        default: break;
+        }
+    }
+    return true;
+}
+
+static void bench_skip(const char* name, const std::string& text, bool tokens, int count) {
+    JsonTokenzier tokenizer;
+    bool ok = true;
+    Stopwatch sw;
+    for (int i = 0; i < count; ++i) {
+        tokenizer.Reset(text.c_str(), text.c_str() + text.size());
+        tokenizer.NextToken();
+        ok &= (tokens ? skip_tokens(tokenizer) : tokenizer.SkipValue());
+    }
+    REPORT_BYTES(name, (double)text.size() * count, sw.seconds());
+    if (!ok) printf("    not skipped\n");
+}
+
+static void bench_level(const char* name, const std::string& text, jslite::SimdLevel level, int count) {
+    const char *end = NULL;
+    Stopwatch sw;
+    for (int i = 0; i < count; ++i) end = jslite::SkipContainer(text.c_str() + 1, text.c_str() + text.size(), level);
+    REPORT_BYTES(name, (double)text.size() * count, sw.seconds());
+    keep(end);
+}
+
+static void bench_all(const char* name, const std::string& text, int count) {
+    printf("%s, %zu bytes\n", name, text.size());
+    bench_skip("  tokens", text, true, count);
+    bench_skip("  SkipValue", text, false, count);
+    bench_level("  SkipContainer, scalar", text, jslite::SIMD_SCALAR, count);
+    if (jslite::simd_level() >= jslite::SIMD_SSE2) bench_level("  SkipContainer, sse2", text, jslite::SIMD_SSE2, count);
+    if (jslite::simd_level() >= jslite::SIMD_AVX2) bench_level("  SkipContainer, avx2", text, jslite::SIMD_AVX2, count);
+}
+
+int main() {
+    printf("simd level %d\n", jslite::simd_level());
+
+    bench_all("string heavy", make_strings(20000), 10);
+    bench_all("deeply nested", make_nested(20000), 200);
+
+    return 0;
+}
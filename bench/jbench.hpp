@@ -0,0 +1,35 @@
+#ifndef __JBENCH_HPP__
+#define __JBENCH_HPP__
+
+#include <stdio.h>
+#include <chrono>
+#include <string>
+
+class Stopwatch {
+public:
+    Stopwatch() : begin_(std::chrono::steady_clock::now()) {}
+
+    void reset() { begin_ = std::chrono::steady_clock::now(); }
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point begin_;
+};
+
+// keeps the optimizer from dropping a result
+template <typename T>
+inline void keep(const T& val) {
+    static const void* volatile sink;
+    sink = &val;
+}
+
+#define REPORT(name, ops, secs) \
+    printf("%-40s %12.1f ns/op %14.0f ops/s\n", (name), (secs) * 1e9 / (ops), (ops) / (secs))
+
+#define REPORT_BYTES(name, bytes, secs) \
+    printf("%-40s %12.1f MB/s\n", (name), (bytes) / (secs) / (1024.0 * 1024.0))
+
+#endif //__JBENCH_HPP__
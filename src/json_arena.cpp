@@ -0,0 +1,94 @@
+#include "json_arena.hpp"
+
+#include <stdlib.h>
+#include <algorithm>
+
+namespace jslite {
+
+const size_t MAX_BLOCK_SIZE = 16 * 1024 * 1024;
+
+static char* align_up(char* p, size_t align) {
+    uintptr_t v = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<char*>((v + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+Arena::Arena(size_t block_size)
+    : head_(NULL), cleanups_(NULL), ptr_(NULL), end_(NULL),
+      block_size_(block_size), next_size_(block_size),
+      used_(0), reserved_(0), blocks_(0) {}
+
+Arena::~Arena() { Clear(); }
+
+void* Arena::Allocate(size_t size, size_t align) {
+    char *p = align_up(ptr_, align);
+    if (NULL == ptr_ || p + size > end_) {
+        Grow(size + align);
+        p = align_up(ptr_, align);
+    }
+    ptr_ = p + size;
+    used_ += size;
+    return p;
+}
+
+void Arena::Clear() {
+    // objects are destroyed in reverse order of registration
+    for (Cleanup *it = cleanups_; it; it = it->next) it->func(it->obj);
+    cleanups_ = NULL;
+
+    while (head_) {
+        Block *next = head_->next;
+        free(head_);
+        head_ = next;
+    }
+
+    ptr_ = end_ = NULL;
+    next_size_ = block_size_;
+    used_ = reserved_ = blocks_ = 0;
+}
+
+void Arena::Reset() {
+    if (NULL == head_) return;
+
+    for (Cleanup *it = cleanups_; it; it = it->next) it->func(it->obj);
+    cleanups_ = NULL;
+
+    // the newest block is the largest
+    while (head_->next) {
+        Block *next = head_->next->next;
+        free(head_->next);
+        head_->next = next;
+    }
+
+    ptr_ = reinterpret_cast<char*>(head_ + 1);
+    end_ = reinterpret_cast<char*>(head_) + head_->size;
+    used_ = 0;
+    reserved_ = head_->size;
+    blocks_ = 1;
+}
+
+void Arena::AddCleanup(void* obj, void (*func)(void*)) {
+    Cleanup *cleanup = New<Cleanup>();
+    cleanup->obj = obj;
+    cleanup->func = func;
+    cleanup->next = cleanups_;
+    cleanups_ = cleanup;
+}
+
+void Arena::Grow(size_t size) {
+    size_t block_size = std::max(next_size_, size + sizeof(Block));
+    Block *block = static_cast<Block*>(malloc(block_size));
+    if (NULL == block) throw std::bad_alloc();
+
+    block->next = head_;
+    block->size = block_size;
+    head_ = block;
+
+    ptr_ = reinterpret_cast<char*>(block + 1);
+    end_ = reinterpret_cast<char*>(block) + block_size;
+
+    reserved_ += block_size;
+    ++blocks_;
+    if (next_size_ < MAX_BLOCK_SIZE) next_size_ = std::min(next_size_ * 2, MAX_BLOCK_SIZE);
+}
+
+} // namespace jslite
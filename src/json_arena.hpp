@@ -0,0 +1,109 @@
+#ifndef __JS_JSON_ARENA_HPP_20150112__
+#define __JS_JSON_ARENA_HPP_20150112__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <utility>
+
+namespace jslite {
+
+// bump allocator. memory is handed out from large blocks and only released
+// as a whole by Clear() or the destructor.
+class Arena {
+public:
+    explicit Arena(size_t block_size = 64 * 1024);
+    ~Arena();
+
+    void* Allocate(size_t size, size_t align = sizeof(void*));
+
+    template <typename T, class... Args>
+    T* New(Args&&... args) {
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // registers obj to be destroyed when the arena is released.
+    template <typename T>
+    void Own(T* obj) { AddCleanup(obj, &Destroy<T>); }
+
+    void Clear();
+    // like Clear(), but the newest block is kept for what comes next
+    void Reset();
+
+    size_t used() const { return used_; }         // bytes handed out
+    size_t reserved() const { return reserved_; } // bytes of all blocks
+    size_t blocks() const { return blocks_; }
+
+protected:
+    struct Block {
+        Block *next;
+        size_t size;
+    };
+
+    struct Cleanup {
+        Cleanup *next;
+        void    *obj;
+        void   (*func)(void*);
+    };
+
+    template <typename T>
+    static void Destroy(void* obj) { static_cast<T*>(obj)->~T(); }
+
+    void AddCleanup(void* obj, void (*func)(void*));
+    void Grow(size_t size);
+
+private:
+    Arena(const Arena&);
+    Arena& operator = (const Arena&);
+
+    Block   *head_;
+    Cleanup *cleanups_;
+    char    *ptr_;
+    char    *end_;
+    size_t   block_size_;
+    size_t   next_size_;
+    size_t   used_;
+    size_t   reserved_;
+    size_t   blocks_;
+};
+
+// stateful allocator on top of Arena. without an arena it falls back to the
+// global operator new, so containers work the same on the heap.
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    ArenaAllocator() : arena_(NULL) {}
+    explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(size_t n) {
+        if (arena_) return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t) {
+        if (!arena_) ::operator delete(p);
+    }
+
+    // a copy of a container does not share the arena of its origin
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    Arena* arena() const { return arena_; }
+
+private:
+    Arena *arena_;
+};
+
+template <typename T, typename U>
+bool operator == (const ArenaAllocator<T>& l, const ArenaAllocator<U>& r) { return l.arena() == r.arena(); }
+
+template <typename T, typename U>
+bool operator != (const ArenaAllocator<T>& l, const ArenaAllocator<U>& r) { return l.arena() != r.arena(); }
+
+} // namespace jslite
+
+#endif //__JS_JSON_ARENA_HPP_20150112__
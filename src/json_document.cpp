@@ -0,0 +1,25 @@
+#include "json_document.hpp"
+
+namespace jslite {
+
+JsonDocument::JsonDocument(size_t block_size) : arena_(block_size), keys_(&arena_) {
+    root_.Adopt(&arena_);
+}
+
+JsonDocument::~JsonDocument() {
+    root_.clear();
+}
+
+void JsonDocument::clear() {
+    root_.clear();
+    keys_.clear();
+    arena_.Clear();
+}
+
+void JsonDocument::reset() {
+    root_.clear();
+    keys_.clear();
+    arena_.Reset();
+}
+
+} // namespace jslite
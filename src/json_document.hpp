@@ -0,0 +1,47 @@
+#ifndef __JS_JSON_DOCUMENT_HPP_20150112__
+#define __JS_JSON_DOCUMENT_HPP_20150112__
+
+#include "jsonlite.hpp"
+#include "json_arena.hpp"
+
+namespace jslite {
+
+// a json tree of which all values, strings and containers are allocated
+// from one arena. the whole tree is released at once without visiting
+// each value.
+//
+// copying a value out of the document, or move-assigning it to a value
+// on the heap, makes an independent copy there, so it stays valid after
+// the document is cleared. a value move-constructed from it takes over
+// its payload in the arena instead, and is valid only as long as that.
+class JsonDocument {
+public:
+    explicit JsonDocument(size_t block_size = 64 * 1024);
+    ~JsonDocument();
+
+    Json& root() { return root_; }
+    const Json& root() const { return root_; }
+
+    Arena& arena() { return arena_; }
+    JsonKeyPool& keys() { return keys_; } // interned keys of the document
+
+    void clear();
+    // clears the document but keeps a block of the arena, so parsing the
+    // next value of about the same size allocates nothing
+    void reset();
+
+    size_t used() const { return arena_.used(); }
+    size_t reserved() const { return arena_.reserved(); }
+
+private:
+    JsonDocument(const JsonDocument&);
+    JsonDocument& operator = (const JsonDocument&);
+
+    Arena       arena_;
+    JsonKeyPool keys_;
+    Json        root_;
+};
+
+} // namespace jslite
+
+#endif //__JS_JSON_DOCUMENT_HPP_20150112__
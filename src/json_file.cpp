@@ -0,0 +1,181 @@
+#include "json_file.hpp"
+#include "json_document.hpp"
+
+#include <stdio.h>
+#include <algorithm>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace jslite {
+
+const size_t DEFAULT_RELEASE_SIZE = 16 * 1024 * 1024;
+
+JsonMappedFile::JsonMappedFile() : data_(NULL), size_(0), released_(0) {}
+
+JsonMappedFile::~JsonMappedFile() { Close(); }
+
+#ifndef WIN32
+int32_t JsonMappedFile::Open(const char* path) {
+    Close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return ERR_FILE;
+
+    struct stat st;
+    if (0 != fstat(fd, &st)) {
+        ::close(fd);
+        return ERR_FILE;
+    }
+
+    // an empty file can not be mapped, and has no text anyway
+    if (st.st_size > 0) {
+        void *addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED == addr) {
+            ::close(fd);
+            return ERR_FILE;
+        }
+        madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+        data_ = (const char*)addr;
+        size_ = (size_t)st.st_size;
+    }
+    ::close(fd); // the mapping keeps the file
+    return 0;
+}
+
+void JsonMappedFile::Close() {
+    if (data_) munmap((void*)data_, size_);
+    data_ = NULL;
+    size_ = released_ = 0;
+}
+
+void JsonMappedFile::Release(size_t offset) {
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    offset = std::min(offset, size_) / page * page;
+    if (offset <= released_) return;
+
+    madvise((void*)(data_ + released_), offset - released_, MADV_DONTNEED);
+    released_ = offset;
+}
+#else
+// read into memory, without a mapping
+int32_t JsonMappedFile::Open(const char* path) {
+    Close();
+
+    FILE *fp = fopen(path, "rb");
+    if (NULL == fp) return ERR_FILE;
+
+    char chunk[64 * 1024];
+    size_t len = 0;
+    while ((len = fread(chunk, 1, sizeof(chunk), fp)) > 0) buf_.insert(buf_.end(), chunk, chunk + len);
+    const bool failed = (0 != ferror(fp));
+    fclose(fp);
+    if (failed) {
+        buf_.clear();
+        return ERR_FILE;
+    }
+
+    data_ = (buf_.empty() ? NULL : &buf_[0]);
+    size_ = buf_.size();
+    return 0;
+}
+
+void JsonMappedFile::Close() {
+    std::vector<char>().swap(buf_);
+    data_ = NULL;
+    size_ = released_ = 0;
+}
+
+void JsonMappedFile::Release(size_t /*offset*/) {}
+#endif
+
+JsonFileReader::JsonFileReader()
+    : mode_(RECORDS_VALUES), flags_(PARSE_DEFAULT), max_depth_(MAX_PARSE_DEPTH), release_size_(DEFAULT_RELEASE_SIZE), released_(0),
+      records_(0), done_(true), error_(0) {}
+
+int32_t JsonFileReader::Open(const char* path, RecordMode mode) {
+    Close();
+
+    int32_t ret = file_.Open(path);
+    if (0 != ret) return Stop(ret);
+
+    mode_ = mode;
+    tokenizer_.Reset(file_.data(), file_.data() + file_.size());
+    tokenizer_.SkipSpace();
+    done_ = tokenizer_.IsDone();
+
+    if (RECORDS_ARRAY == mode_) {
+        if ('[' != tokenizer_.Bump()) return Stop(ERR_VALUE);
+        tokenizer_.SkipSpace();
+        if (']' == tokenizer_.Current()) {
+            tokenizer_.Bump();
+            tokenizer_.SkipSpace();
+            if (!tokenizer_.IsDone()) return Stop(ERR_VALUE);
+            done_ = true;
+        }
+    }
+    return 0;
+}
+
+void JsonFileReader::Close() {
+    file_.Close();
+    tokenizer_.Reset(NULL, NULL);
+    released_ = records_ = 0;
+    done_ = true;
+    error_ = 0;
+}
+
+int32_t JsonFileReader::Next(Json& json) {
+    json.clear();
+    JsonDomBuilder builder(json, &keys_);
+    return Next(builder);
+}
+
+int32_t JsonFileReader::Next(JsonDocument& doc) {
+    doc.reset();
+    JsonDomBuilder builder(doc.root(), &doc.keys());
+    return Next(builder);
+}
+
+size_t JsonFileReader::offset() const {
+    return tokenizer_.offset();
+}
+
+// the separator after a record. done_ is set at the end of the records.
+int32_t JsonFileReader::After() {
+    tokenizer_.SkipSpace();
+    if (RECORDS_ARRAY == mode_) {
+        const char c = tokenizer_.Bump();
+        if (']' == c) {
+            tokenizer_.SkipSpace();
+            if (!tokenizer_.IsDone()) return ERR_VALUE;
+            done_ = true;
+        } else if (',' != c) {
+            return ERR_ARRAY_END;
+        }
+        return 0;
+    }
+    done_ = tokenizer_.IsDone();
+    return 0;
+}
+
+// an error stops the reader; a record releases the pages before it
+int32_t JsonFileReader::Stop(int32_t ret) {
+    if (0 != ret) {
+        done_ = true;
+        error_ = ret;
+        return ret;
+    }
+
+    ++records_;
+    if (release_size_ && offset() - released_ >= release_size_) {
+        released_ = offset();
+        file_.Release(released_);
+    }
+    return 0;
+}
+
+} //namespace jslite
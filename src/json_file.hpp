@@ -0,0 +1,122 @@
+#ifndef __JS_JSON_FILE_HPP_20150121__
+#define __JS_JSON_FILE_HPP_20150121__
+
+#include <vector>
+#include <stdint.h>
+
+#include "jsonlite.hpp"
+#include "json_sax.hpp"
+#include "json_stream.hpp"
+#include "json_tokenizer.hpp"
+
+namespace jslite {
+
+// a file mapped read-only into memory, so its text is parsed where it is
+// instead of being read into a string first.
+//
+//   JsonMappedFile file;
+//   if (0 == file.Open(path)) ret = stream.Parse(file.text(), doc);
+//
+// with PARSE_ZERO_COPY the strings of doc point into the mapping and stay
+// valid until the file is closed.
+class JsonMappedFile {
+public:
+    JsonMappedFile();
+    ~JsonMappedFile();
+
+    // 0 or ERR_FILE. the pages are read ahead in order.
+    int32_t Open(const char* path);
+    void Close();
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    StringRef text() const { return StringRef(data_, size_); }
+
+    // the pages before offset are given back to the system. they are read
+    // from the file again if they are used after that.
+    void Release(size_t offset);
+
+private:
+    JsonMappedFile(const JsonMappedFile&);
+    JsonMappedFile& operator = (const JsonMappedFile&);
+
+    const char       *data_;
+    size_t            size_;
+    size_t            released_; // pages before it were released
+    std::vector<char> buf_;      // the file where it can not be mapped
+};
+
+typedef enum {
+    RECORDS_VALUES = 0, // values one after another, like lines of NDJSON
+    RECORDS_ARRAY,      // the elements of an array around the whole file
+} RecordMode;
+
+// parses a file that may be larger than memory one record at a time.
+// the pages of the records already parsed are released as it goes on, so
+// what stays in memory is about the size of a record.
+//
+//   JsonFileReader reader;
+//   reader.Open(path, RECORDS_ARRAY);
+//   while (!reader.IsDone()) {
+//       Json record;
+//       if (0 != (ret = reader.Next(record))) break;
+//   }
+class JsonFileReader {
+public:
+    JsonFileReader();
+
+    int32_t Open(const char* path, RecordMode mode = RECORDS_VALUES);
+    void Close();
+
+    // no records left, or an error stopped the reader
+    bool IsDone() const { return done_; }
+
+    int32_t Next(Json& json);
+    int32_t Next(JsonDocument& doc); // values are allocated from doc
+
+    // events of the next record to handler
+    template <class Handler>
+    int32_t Next(Handler& handler) {
+        if (done_) return (error_ ? error_ : ERR_VALUE);
+
+        JsonSaxParser<Handler> parser(handler, flags_);
+        parser.set_max_depth(max_depth_);
+        int32_t ret = parser.Parse(tokenizer_);
+        if (0 == ret) ret = After();
+        return Stop(ret);
+    }
+
+    // PARSE_ZERO_COPY and PARSE_LAZY_NUMBERS point into the mapping
+    void set_parse_flags(uint32_t flags) { flags_ = flags; }
+    void set_max_depth(size_t depth) { max_depth_ = depth; }
+    // bytes between releases of the pages used, 0 keeps them all
+    void set_release_size(size_t bytes) { release_size_ = bytes; }
+
+    JsonKeyPool& key_pool() { return keys_; }
+    const JsonMappedFile& file() const { return file_; }
+
+    // bytes parsed and records read so far
+    size_t offset() const;
+    size_t records() const { return records_; }
+
+protected:
+    int32_t After();
+    int32_t Stop(int32_t ret);
+
+private:
+    JsonMappedFile  file_;
+    JsonTokenzier   tokenizer_;
+    JsonKeyPool     keys_;
+    RecordMode      mode_;
+    uint32_t        flags_;
+    size_t          max_depth_;
+    size_t          release_size_;
+    size_t          released_; // offset of the last release
+    size_t          records_;
+    bool            done_;
+    int32_t         error_;
+};
+
+} //namespace jslite
+
+#endif //__JS_JSON_FILE_HPP_20150121__
@@ -0,0 +1,268 @@
+#include "json_lines.hpp"
+#include "json_document.hpp"
+#include "json_number.hpp"
+#include "json_simd.hpp"
+
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace jslite {
+
+const size_t LINES_RELEASE_SIZE = 16 * 1024 * 1024;
+
+JsonLineReader::JsonLineReader()
+    : parser_(builder_), flags_(PARSE_DEFAULT), max_depth_(MAX_PARSE_DEPTH), projection_(NULL) {
+    Reset();
+}
+
+void JsonLineReader::Reset() {
+    data_ = NULL;
+    size_ = pos_ = 0;
+    finished_ = false;
+    buf_.clear();
+    file_.Close();
+    released_ = 0;
+    line_ = records_ = errors_ = 0;
+}
+
+void JsonLineReader::Reset(const StringRef& text) {
+    Reset();
+    data_ = text.data;
+    size_ = text.size;
+    finished_ = true;
+}
+
+int32_t JsonLineReader::Open(const char* path) {
+    Reset();
+    finished_ = true;
+
+    int32_t ret = file_.Open(path);
+    if (0 != ret) return ret;
+    data_ = file_.data();
+    size_ = file_.size();
+    return 0;
+}
+
+void JsonLineReader::Feed(const char* data, size_t len) {
+    // the lines already read are not needed anymore
+    if (pos_ > 0) {
+        buf_.erase(0, pos_);
+        pos_ = 0;
+    }
+    buf_.append(data, len);
+    data_ = buf_.data();
+    size_ = buf_.size();
+}
+
+int32_t JsonLineReader::Next(Json& json) {
+    return Next(json, keys_);
+}
+
+int32_t JsonLineReader::Next(Json& json, JsonKeyPool& keys) {
+    StringRef line;
+    int32_t ret = NextLine(line);
+    if (0 != ret) return ret;
+
+    json.clear();
+    builder_.Reset(json, &keys);
+    return Parse(parser_, line);
+}
+
+int32_t JsonLineReader::Next(JsonDocument& doc) {
+    StringRef line;
+    int32_t ret = NextLine(line);
+    if (0 != ret) return ret;
+
+    doc.reset();
+    builder_.Reset(doc.root(), &doc.keys());
+    return Parse(parser_, line);
+}
+
+void JsonLineReader::set_parse_flags(uint32_t flags) {
+    flags_ = flags;
+    parser_.set_parse_flags(flags);
+}
+
+void JsonLineReader::set_max_depth(size_t depth) {
+    max_depth_ = depth;
+    parser_.set_max_depth(depth);
+}
+
+void JsonLineReader::set_projection(const JsonProjection* projection) {
+    projection_ = projection;
+    parser_.set_projection(projection);
+}
+
+// the next line that is not blank, without its newline
+int32_t JsonLineReader::NextLine(StringRef& line) {
+    for (;;) {
+        if (pos_ >= size_) return (finished_ ? LINES_END : LINES_MORE);
+
+        const char *begin = data_ + pos_, *end = data_ + size_;
+        const char *newline = (const char*)memchr(begin, '\n', end - begin);
+        if (NULL == newline) {
+            if (!finished_) return LINES_MORE;
+            newline = end;
+        }
+        pos_ = (newline - data_) + (newline != end);
+        ++line_;
+        if (SkipSpaces(begin, newline) == newline) continue;
+
+        // pages of a file before the line go back to the system
+        if (file_.data() && pos_ - released_ >= LINES_RELEASE_SIZE) {
+            file_.Release(begin - data_);
+            released_ = pos_;
+        }
+
+        ++records_;
+        line = StringRef(begin, newline - begin);
+        return 0;
+    }
+}
+
+int32_t JsonLineWriter::Write(const Json& json) {
+    const size_t size = buf_.size();
+    int32_t ret = WriteValue(json);
+    if (0 != ret) {
+        buf_.resize(size);
+        return ret;
+    }
+    buf_ += '\n';
+    ++records_;
+    return 0;
+}
+
+void JsonLineWriter::clear() {
+    buf_.clear();
+    records_ = 0;
+}
+
+void JsonLineWriter::swap(std::string& buf) {
+    buf_.swap(buf);
+    buf_.clear();
+    records_ = 0;
+}
+
+static void AppendInteger(std::string& buf, uint64_t value, bool negative) {
+    char digits[24];
+    char *p = digits + sizeof(digits);
+    do {
+        *--p = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    if (negative) *--p = '-';
+    buf.append(p, digits + sizeof(digits) - p);
+}
+
+// snprintf() with the decimal point of the current locale made a '.'
+static int FormatReal(char* digits, size_t size, const char* format, double value) {
+    int len = snprintf(digits, size, format, value);
+    const char *point = localeconv()->decimal_point;
+    if ('.' == point[0] && '\0' == point[1]) return len;
+
+    char *p = strstr(digits, point);
+    if (NULL == p) return len;
+    const size_t n = strlen(point);
+    *p = '.';
+    memmove(p + 1, p + n, digits + len + 1 - (p + n));
+    return len - (int)(n - 1);
+}
+
+// the shortest of 15 or 17 digits that reads back the same value, and
+// still a real when it has no fraction
+static void AppendReal(std::string& buf, double value) {
+    char digits[32];
+    int len = FormatReal(digits, sizeof(digits), "%.15g", value);
+    JsonNumber number;
+    ScanNumber(digits, digits + len, number);
+    if (NumberToDouble(number, digits, digits + len) != value) len = FormatReal(digits, sizeof(digits), "%.17g", value);
+    buf.append(digits, len);
+    if (NULL == strpbrk(digits, ".e")) buf += ".0";
+}
+
+int32_t JsonLineWriter::WriteValue(const Json& json) {
+    // numbers kept as text are written as they were parsed
+    StringRef raw = json.number_ref();
+    if (raw.data) {
+        buf_.append(raw.data, raw.size);
+        return 0;
+    }
+
+    int32_t ret = 0;
+    switch(json.type()) {
+    case Json::TYPE_NULL:     buf_ += "null"; break;
+    case Json::TYPE_BOOLEAN:  buf_ += (json.boolean() ? "true" : "false"); break;
+    case Json::TYPE_INTEGER: {
+        const Json::Integer value = json.integer();
+        AppendInteger(buf_, (value < 0 ? 0 - (uint64_t)value : (uint64_t)value), value < 0);
+        break;
+    }
+    case Json::TYPE_UINTEGER: AppendInteger(buf_, json.uinteger(), false); break;
+    case Json::TYPE_REAL:
+        if (!isfinite(json.real())) return ERR_JSON_TYPE;
+        AppendReal(buf_, json.real());
+        break;
+    case Json::TYPE_STRING: {
+        const StringRef str = json.string_ref();
+        WriteString(str.data, str.size);
+        break;
+    }
+    case Json::TYPE_ARRAY:
+        buf_ += '[';
+        for (size_t i = 0; i < json.size(); ++i) {
+            if (i) buf_ += ',';
+            if (0 != (ret = WriteValue(json[i]))) return ret;
+        }
+        buf_ += ']';
+        break;
+    case Json::TYPE_OBJECT: {
+        const Json::Object &obj = json.object();
+        buf_ += '{';
+        for (Json::Object::const_iterator it = obj.begin(); it != obj.end(); ++it) {
+            if (it != obj.begin()) buf_ += ',';
+            WriteString(it->first.c_str(), it->first.size());
+            buf_ += ':';
+            if (0 != (ret = WriteValue(it->second))) return ret;
+        }
+        buf_ += '}';
+        break;
+    }
+    default:
+        return ERR_JSON_TYPE;
+    }
+    return 0;
+}
+
+void JsonLineWriter::WriteString(const char* str, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+    const char *it = str, *end = str + len;
+
+    buf_ += '"';
+    while (it != end) {
+        const char *stop = ScanString(it, end);
+        buf_.append(it, stop - it);
+        if (stop == end) break;
+
+        switch(*stop) {
+        case '"':  buf_ += "\\\""; break;
+        case '\\': buf_ += "\\\\"; break;
+        case '\b': buf_ += "\\b"; break;
+        case '\f': buf_ += "\\f"; break;
+        case '\n': buf_ += "\\n"; break;
+        case '\r': buf_ += "\\r"; break;
+        case '\t': buf_ += "\\t"; break;
+        default: {
+            const char escape[] = { '\\', 'u', '0', '0', hex[(*stop >> 4) & 0xF], hex[*stop & 0xF] };
+            buf_.append(escape, sizeof(escape));
+            break;
+        }
+        }
+        it = stop + 1;
+    }
+    buf_ += '"';
+}
+
+} //namespace jslite
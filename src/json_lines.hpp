@@ -0,0 +1,154 @@
+#ifndef __JS_JSON_LINES_HPP_20150122__
+#define __JS_JSON_LINES_HPP_20150122__
+
+#include <string>
+#include <stdint.h>
+
+#include "jsonlite.hpp"
+#include "json_file.hpp"
+#include "json_sax.hpp"
+#include "json_stream.hpp"
+#include "json_tokenizer.hpp"
+
+namespace jslite {
+
+typedef enum {
+	LINES_END = -1, // no records left
+	LINES_MORE = -2, // the next record needs more data from Feed()
+} LineStatus;
+
+// reads newline delimited json (NDJSON, JSON Lines) one record at a time,
+// from a buffer, a file or chunks of input. blank lines are skipped.
+//
+//   JsonLineReader reader;
+//   reader.Reset(text);
+//   JsonDocument doc;
+//   while (LINES_END != (ret = reader.Next(doc))) {
+//       if (0 != ret) { ... a bad line, the next one is read anyway }
+//   }
+//
+// Next() returns 0, an error of ErrnoNo for the line, LINES_END or
+// LINES_MORE. one parser is used for all records, and a document keeps
+// its memory from one record to the next.
+class JsonLineReader {
+public:
+    JsonLineReader();
+
+    // starts over, for chunks of input
+    void Reset();
+    // the text of the caller, which is not copied
+    void Reset(const StringRef& text);
+    // a file, mapped while it is read. 0 or ERR_FILE.
+    int32_t Open(const char* path);
+    // chunks of input, which may split lines anywhere. Finish() tells that
+    // no more come, so a last line without a newline is a record.
+    void Feed(const char* data, size_t len);
+    void Feed(const std::string& data) { Feed(data.data(), data.size()); }
+    void Finish() { finished_ = true; }
+
+    int32_t Next(Json& json);
+    int32_t Next(JsonDocument& doc); // values are allocated from doc
+    // keys interned into keys, like the pool of the document json is in
+    int32_t Next(Json& json, JsonKeyPool& keys);
+
+    // events of the next record to handler
+    template <class Handler>
+    int32_t Next(Handler& handler) {
+        StringRef line;
+        int32_t ret = NextLine(line);
+        if (0 != ret) return ret;
+
+        JsonSaxParser<Handler> parser(handler, flags_);
+        parser.set_max_depth(max_depth_);
+        parser.set_projection(projection_);
+        return Parse(parser, line);
+    }
+
+    // with PARSE_ZERO_COPY or PARSE_LAZY_NUMBERS views point into the text,
+    // the file, or the data fed, where they last until the next Feed()
+    void set_parse_flags(uint32_t flags);
+    void set_max_depth(size_t depth);
+    // only the values of projection are parsed, NULL for all of them
+    void set_projection(const JsonProjection* projection);
+
+    JsonKeyPool& key_pool() { return keys_; }
+
+    // line number of the last record, from 1
+    size_t line() const { return line_; }
+    // records read and the ones of them that were bad
+    size_t records() const { return records_; }
+    size_t errors() const { return errors_; }
+
+protected:
+    int32_t NextLine(StringRef& line);
+
+    // one value and nothing but spaces after it
+    template <class Parser>
+    int32_t Parse(Parser& parser, const StringRef& line) {
+        tokenizer_.Reset(line.data, line.data + line.size);
+        int32_t ret = parser.Parse(tokenizer_);
+        if (0 == ret) {
+            tokenizer_.SkipSpace();
+            if (!tokenizer_.IsDone()) ret = ERR_VALUE;
+        }
+        if (0 != ret) ++errors_;
+        return ret;
+    }
+
+private:
+    JsonLineReader(const JsonLineReader&);
+    JsonLineReader& operator = (const JsonLineReader&);
+
+    JsonTokenzier                   tokenizer_;
+    JsonDomBuilder                  builder_;
+    JsonSaxParser<JsonDomBuilder>   parser_;  // with builder_, for all records
+    JsonKeyPool                     keys_;
+    uint32_t                        flags_;
+    size_t                          max_depth_;
+    const JsonProjection           *projection_;
+
+    const char      *data_;     // the text
+    size_t           size_;
+    size_t           pos_;      // start of the next line
+    bool             finished_; // no data comes after size_
+    std::string      buf_;      // the data fed
+    JsonMappedFile   file_;
+    size_t           released_; // of file_
+
+    size_t line_;
+    size_t records_;
+    size_t errors_;
+};
+
+// writes records as compact lines into a buffer that grows, to be sent or
+// written out as a whole. members are written in the order they were
+// added, and reals with the digits that read back the same value.
+class JsonLineWriter {
+public:
+    JsonLineWriter() : records_(0) {}
+
+    // 0, or ERR_JSON_TYPE with nothing written for a real that is not
+    // finite
+    int32_t Write(const Json& json);
+
+    const std::string& str() const { return buf_; }
+    size_t size() const { return buf_.size(); }
+    size_t records() const { return records_; }
+
+    // empties the buffer, which keeps its capacity
+    void clear();
+    // hands the buffer over and starts an empty one
+    void swap(std::string& buf);
+
+protected:
+    int32_t WriteValue(const Json& json);
+    void WriteString(const char* str, size_t len);
+
+private:
+    std::string buf_;
+    size_t      records_;
+};
+
+} //namespace jslite
+
+#endif //__JS_JSON_LINES_HPP_20150122__
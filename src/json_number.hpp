@@ -0,0 +1,41 @@
+#ifndef __JS_JSON_NUMBER_HPP_20150115__
+#define __JS_JSON_NUMBER_HPP_20150115__
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace jslite {
+
+// a number split into its decimal parts by ScanNumber()
+struct JsonNumber {
+    uint64_t mantissa;  // the first 19 significant digits
+    int64_t  exponent;  // power of ten of the mantissa
+    bool     negative;
+    bool     integral;  // neither a fraction nor an exponent
+    bool     truncated; // digits after the first 19 were dropped
+    bool     valid;     // follows the grammar of rfc 7159
+};
+
+typedef enum {
+    NUMBER_INTEGER, NUMBER_UINTEGER, NUMBER_REAL
+} NumberType;
+
+// reads -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? at begin, and any
+// other characters of numbers after it, which make the number invalid.
+// returns the end of the number.
+const char* ScanNumber(const char* begin, const char* end, JsonNumber& number);
+
+// integral numbers of up to 9 digits are integers. larger ones are
+// integers while they fit int64_t when negative, or unsigned integers
+// while they fit uint64_t. value is the integer, the others are reals.
+// end is the end of the text of the number.
+NumberType ClassifyNumber(const JsonNumber& number, const char* end, uint64_t& value);
+
+// the closest double to the number. exact mantissas go through the fast
+// paths of Clinger and Eisel-Lemire. strtod() is left for the few numbers
+// of more than 19 digits they can not decide.
+double NumberToDouble(const JsonNumber& number, const char* begin, const char* end);
+
+} // namespace jslite
+
+#endif //__JS_JSON_NUMBER_HPP_20150115__
@@ -0,0 +1,370 @@
+#include "jsonlite.hpp"
+#include "json_util.hpp"
+
+namespace jslite {
+
+const size_t MIN_INDEX_SLOTS = 64;
+
+size_t JsonKey::Hash(const char* data, size_t len) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char *end = data + len; data != end; ++data) {
+        hash ^= static_cast<uint8_t>(*data);
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash);
+}
+
+std::ostream& operator << (std::ostream& os, const JsonKey& key) {
+    return os << key.str();
+}
+
+JsonObject::JsonObject(const allocator_type& alloc)
+    : arena_(alloc.arena()), members_(NULL), size_(0), capacity_(0), index_(NULL), index_mask_(0) {}
+
+JsonObject::JsonObject(const JsonObject& other)
+    : arena_(NULL), members_(NULL), size_(0), capacity_(0), index_(NULL), index_mask_(0) {
+    CopyFrom(other);
+}
+
+JsonObject::JsonObject(const JsonObject& other, const allocator_type& alloc)
+    : arena_(alloc.arena()), members_(NULL), size_(0), capacity_(0), index_(NULL), index_mask_(0) {
+    CopyFrom(other);
+}
+
+JsonObject::JsonObject(JsonObject&& other) noexcept
+    : arena_(other.arena_), members_(NULL), size_(0), capacity_(0), index_(NULL), index_mask_(0) {
+    MoveFrom(other);
+}
+
+JsonObject::JsonObject(JsonObject&& other, const allocator_type& alloc)
+    : arena_(alloc.arena()), members_(NULL), size_(0), capacity_(0), index_(NULL), index_mask_(0) {
+    MoveFrom(other);
+}
+
+JsonObject::~JsonObject() { Release(); }
+
+JsonObject& JsonObject::operator = (const JsonObject& other) {
+    if (this != &other) {
+        JsonObject tmp(other, get_allocator());
+        Release();
+        MoveFrom(tmp);
+    }
+    return *this;
+}
+
+JsonObject& JsonObject::operator = (JsonObject&& other) {
+    if (this != &other) {
+        Release();
+        MoveFrom(other);
+    }
+    return *this;
+}
+
+void JsonObject::reserve(size_t n) {
+    if (n <= capacity_) return;
+
+    Member *members = static_cast<Member*>(Allocate(n * sizeof(Member), alignof(Member)));
+    for (size_t i = 0; i < size_; ++i) {
+        new (members + i) Member(members_[i].first, get_allocator(), std::move(members_[i].second));
+        members_[i].~Member();
+    }
+    Deallocate(members_);
+
+    members_ = members;
+    capacity_ = n;
+}
+
+void JsonObject::clear() {
+    for (size_t i = 0; i < size_; ++i) {
+        ReleaseKey(members_[i].first);
+        members_[i].~Member();
+    }
+    size_ = 0;
+    if (index_mask_) memset(index_, 0, (index_mask_ + 1) * sizeof(uint32_t));
+}
+
+JsonObject::iterator JsonObject::find(const StringRef& key) {
+    return members_ + Lookup(key.data, key.size, JsonKey::Hash(key.data, key.size));
+}
+
+JsonObject::const_iterator JsonObject::find(const StringRef& key) const {
+    return members_ + Lookup(key.data, key.size, JsonKey::Hash(key.data, key.size));
+}
+
+Json& JsonObject::at(const StringRef& key) {
+    iterator it = find(key);
+    if (it == end()) throw std::out_of_range("no key in object");
+    return it->second;
+}
+
+const Json& JsonObject::at(const StringRef& key) const {
+    const_iterator it = find(key);
+    if (it == end()) throw std::out_of_range("no key in object");
+    return it->second;
+}
+
+Json& JsonObject::operator [] (const StringRef& key) {
+    return emplace(key, Json()).first->second;
+}
+
+std::pair<JsonObject::iterator, bool> JsonObject::emplace(const StringRef& key, Json&& value) {
+    size_t hash = JsonKey::Hash(key.data, key.size);
+    size_t pos = Lookup(key.data, key.size, hash);
+    if (pos != size_) return std::make_pair(members_ + pos, false);
+
+    return Insert(pos, NewKey(key.data, key.size, hash), std::move(value));
+}
+
+std::pair<JsonObject::iterator, bool> JsonObject::emplace(const JsonKey& key, Json&& value) {
+    size_t pos = Lookup(key);
+    if (pos != size_) return std::make_pair(members_ + pos, false);
+
+    return Insert(pos, CopyKey(key), std::move(value));
+}
+
+// appends a member with a key owned by this object at pos(= size_)
+std::pair<JsonObject::iterator, bool> JsonObject::Insert(size_t pos, const JsonKey& key, Json&& value) {
+    if (size_ == capacity_) reserve(capacity_ ? capacity_ * 2 : 4);
+
+    new (members_ + size_) Member(key, get_allocator(), std::move(value));
+    ++size_;
+
+    if (index_mask_ && size_ * 2 <= index_mask_ + 1) {
+        AddIndex(pos);
+    } else if (size_ > INDEX_THRESHOLD) {
+        BuildIndex(std::max(MIN_INDEX_SLOTS, (index_mask_ + 1) * 2));
+    }
+
+    return std::make_pair(members_ + pos, true);
+}
+
+size_t JsonObject::erase(const StringRef& key) {
+    iterator it = find(key);
+    if (it == end()) return 0;
+    erase(it);
+    return 1;
+}
+
+// the following members are moved forward to keep the order
+JsonObject::iterator JsonObject::erase(iterator pos) {
+    Member *last = members_ + size_ - 1;
+    ReleaseKey(pos->first);
+    for (Member *it = pos; it != last; ++it) {
+        it->first = (it + 1)->first;
+        it->second = std::move((it + 1)->second);
+    }
+    last->~Member();
+    --size_;
+
+    if (index_mask_) BuildIndex(index_mask_ + 1);
+
+    return pos;
+}
+
+bool JsonObject::operator == (const JsonObject& other) const {
+    if (size_ != other.size_) return false;
+    for (const_iterator it = begin(); it != end(); ++it) {
+        size_t pos = other.Lookup(it->first.c_str(), it->first.size(), it->first.hash());
+        if (pos == other.size_) return false;
+        if (!(it->second == other.members_[pos].second)) return false;
+    }
+    return true;
+}
+
+size_t JsonObject::Lookup(const char* data, size_t len, size_t hash) const {
+    if (index_mask_) {
+        for (size_t i = hash & index_mask_; ; i = (i + 1) & index_mask_) {
+            uint32_t slot = index_[i];
+            if (0 == slot) return size_;
+            const JsonKey &key = members_[slot - 1].first;
+            if (key.hash_ == hash && key == StringRef(data, len)) return slot - 1;
+        }
+    }
+
+    for (size_t i = 0; i < size_; ++i) {
+        const JsonKey &key = members_[i].first;
+        if (key.hash_ == hash && key == StringRef(data, len)) return i;
+    }
+    return size_;
+}
+
+// an interned key matches by pointer
+size_t JsonObject::Lookup(const JsonKey& key) const {
+    if (index_mask_) {
+        for (size_t i = key.hash_ & index_mask_; ; i = (i + 1) & index_mask_) {
+            uint32_t slot = index_[i];
+            if (0 == slot) return size_;
+            if (members_[slot - 1].first == key) return slot - 1;
+        }
+    }
+
+    for (size_t i = 0; i < size_; ++i) {
+        if (members_[i].first == key) return i;
+    }
+    return size_;
+}
+
+JsonKey JsonObject::NewKey(const char* data, size_t len, size_t hash) const {
+    JsonKey key;
+    key.hash_ = hash;
+    if (arena_) {
+        key.data_ = arena_->New<JsonKey::Data>();
+        key.data_->arena = arena_;
+        key.data_->str.assign(data, len);
+        if (OwnsMemory(key.data_->str)) arena_->Own(&key.data_->str);
+    } else {
+        key.data_ = new JsonKey::Data();
+        key.data_->str.assign(data, len);
+    }
+    return key;
+}
+
+// a key is shared in the same arena or on the heap, otherwise copied
+JsonKey JsonObject::CopyKey(const JsonKey& key) const {
+    if (key.data_->arena != arena_) return NewKey(key.c_str(), key.size(), key.hash_);
+    if (NULL == arena_) ++key.data_->refs;
+    return key;
+}
+
+void JsonObject::ReleaseKey(JsonKey& key) {
+    if (NULL == arena_ && 0 == --key.data_->refs) delete key.data_;
+    key.data_ = NULL;
+}
+
+void JsonObject::CopyFrom(const JsonObject& other) {
+    reserve(other.size_);
+    for (const_iterator it = other.begin(); it != other.end(); ++it) {
+        new (members_ + size_) Member(CopyKey(it->first), get_allocator(), Json());
+        members_[size_].second = it->second;
+        ++size_;
+    }
+    if (other.index_mask_) BuildIndex(other.index_mask_ + 1);
+}
+
+void JsonObject::MoveFrom(JsonObject& other) {
+    if (arena_ != other.arena_) {
+        CopyFrom(other);
+        other.Release();
+        return;
+    }
+
+    members_ = other.members_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    index_ = other.index_;
+    index_mask_ = other.index_mask_;
+
+    other.members_ = NULL;
+    other.index_ = NULL;
+    other.size_ = other.capacity_ = other.index_mask_ = 0;
+}
+
+void JsonObject::Release() {
+    clear();
+    Deallocate(members_);
+    Deallocate(index_);
+    members_ = NULL;
+    index_ = NULL;
+    capacity_ = index_mask_ = 0;
+}
+
+void JsonObject::BuildIndex(size_t slots) {
+    if (slots != index_mask_ + 1) {
+        Deallocate(index_);
+        index_ = static_cast<uint32_t*>(Allocate(slots * sizeof(uint32_t), alignof(uint32_t)));
+        index_mask_ = slots - 1;
+    }
+    memset(index_, 0, slots * sizeof(uint32_t));
+    for (size_t i = 0; i < size_; ++i) AddIndex(i);
+}
+
+void JsonObject::AddIndex(size_t pos) {
+    size_t i = members_[pos].first.hash_ & index_mask_;
+    while (index_[i]) i = (i + 1) & index_mask_;
+    index_[i] = static_cast<uint32_t>(pos + 1);
+}
+
+void* JsonObject::Allocate(size_t size, size_t align) {
+    if (arena_) return arena_->Allocate(size, align);
+    return ::operator new(size);
+}
+
+void JsonObject::Deallocate(void* p) {
+    if (NULL == arena_ && p) ::operator delete(p);
+}
+
+JsonKeyPool::JsonKeyPool(Arena* arena, size_t max_keys, size_t max_length)
+    : arena_(arena), slots_(NULL), mask_(0), size_(0), max_keys_(max_keys), max_length_(max_length),
+      lookups_(0), hits_(0), saved_(0) {}
+
+JsonKeyPool::~JsonKeyPool() {
+    clear();
+    delete [] slots_;
+}
+
+JsonKey JsonKeyPool::Intern(const StringRef& str) {
+    if (str.size > max_length_) return JsonKey();
+
+    ++lookups_;
+    size_t hash = JsonKey::Hash(str.data, str.size);
+    size_t i = hash & mask_;
+    if (slots_) {
+        for (; !slots_[i].empty(); i = (i + 1) & mask_) {
+            if (slots_[i].hash_ == hash && slots_[i] == str) {
+                ++hits_;
+                saved_ += sizeof(JsonKey::Data) + (OwnsMemory(slots_[i].str()) ? str.size + 1 : 0);
+                return slots_[i];
+            }
+        }
+    }
+
+    if (size_ >= max_keys_) return JsonKey();
+    if (NULL == slots_ || (size_ + 1) * 2 > mask_ + 1) {
+        Rehash(slots_ ? (mask_ + 1) * 2 : 64);
+        for (i = hash & mask_; !slots_[i].empty(); i = (i + 1) & mask_);
+    }
+
+    JsonKey &key = slots_[i];
+    key.hash_ = hash;
+    if (arena_) {
+        key.data_ = arena_->New<JsonKey::Data>();
+        key.data_->arena = arena_;
+        key.data_->str.assign(str.data, str.size);
+        if (OwnsMemory(key.data_->str)) arena_->Own(&key.data_->str);
+    } else {
+        key.data_ = new JsonKey::Data();
+        key.data_->str.assign(str.data, str.size);
+    }
+    ++size_;
+
+    return key;
+}
+
+// releases the reference of the pool, keys in use stay with their objects
+void JsonKeyPool::clear() {
+    for (size_t i = 0; slots_ && i <= mask_; ++i) {
+        JsonKey &key = slots_[i];
+        if (key.empty()) continue;
+        if (NULL == arena_ && 0 == --key.data_->refs) delete key.data_;
+        key = JsonKey();
+    }
+    size_ = lookups_ = hits_ = saved_ = 0;
+}
+
+void JsonKeyPool::Rehash(size_t slots) {
+    JsonKey *old = slots_;
+    size_t old_slots = (old ? mask_ + 1 : 0);
+
+    slots_ = new JsonKey[slots];
+    mask_ = slots - 1;
+    for (size_t i = 0; i < old_slots; ++i) {
+        if (old[i].empty()) continue;
+        size_t j = old[i].hash_ & mask_;
+        while (!slots_[j].empty()) j = (j + 1) & mask_;
+        slots_[j] = old[i];
+    }
+    delete [] old;
+}
+
+} // namespace jslite
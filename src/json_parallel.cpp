@@ -0,0 +1,243 @@
+#include "json_parallel.hpp"
+#include "json_lines.hpp"
+#include "json_sax.hpp"
+#include "json_simd.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+namespace jslite {
+
+const size_t PARALLEL_CHUNK_SIZE = 1024 * 1024;
+const size_t PARALLEL_RELEASE_SIZE = 16 * 1024 * 1024;
+
+JsonParallelReader::JsonParallelReader(size_t threads)
+    : chunk_size_(PARALLEL_CHUNK_SIZE), window_(0), order_(ORDER_INPUT),
+      flags_(PARSE_DEFAULT), max_depth_(MAX_PARSE_DEPTH),
+      released_(0), data_(NULL), size_(0), pos_(0),
+      current_(NULL), busy_(0), chunks_(0), stop_(false),
+      taken_(0), records_(0), errors_(0) {
+    set_threads(threads);
+}
+
+JsonParallelReader::~JsonParallelReader() {
+    Close();
+    for (size_t i = 0; i < batches_.size(); ++i) delete batches_[i];
+}
+
+void JsonParallelReader::set_threads(size_t threads) {
+    if (0 == threads) threads = std::thread::hardware_concurrency();
+    threads_ = std::max(threads, (size_t)1);
+}
+
+void JsonParallelReader::Reset(const StringRef& text) {
+    Close();
+    Start(text.data, text.size);
+}
+
+int32_t JsonParallelReader::Open(const char* path) {
+    Close();
+    int32_t ret = file_.Open(path);
+    if (0 != ret) return ret;
+    Start(file_.data(), file_.size());
+    return 0;
+}
+
+void JsonParallelReader::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    free_cv_.notify_all();
+    for (size_t i = 0; i < workers_.size(); ++i) workers_[i].join();
+    workers_.clear();
+
+    file_.Close();
+    data_ = NULL;
+    size_ = pos_ = 0;
+}
+
+void JsonParallelReader::Start(const char* data, size_t size) {
+    data_ = data;
+    size_ = size;
+    pos_ = released_ = 0;
+    busy_ = chunks_ = 0;
+    stop_ = false;
+    taken_ = records_ = errors_ = 0;
+
+    // every batch is free again
+    const size_t window = std::max(window_, threads_ + 1);
+    while (batches_.size() < window) batches_.push_back(new JsonLineBatch());
+    free_.assign(batches_.begin(), batches_.begin() + window);
+    ready_.clear();
+    current_ = NULL;
+
+    for (size_t i = 0; i < threads_; ++i) workers_.push_back(std::thread(&JsonParallelReader::Work, this));
+}
+
+bool JsonParallelReader::Take(JsonLineBatch*& batch, StringRef& chunk) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_ && pos_ < size_ && free_.empty()) free_cv_.wait(lock);
+    if (stop_ || pos_ >= size_) return false;
+
+    batch = free_.back();
+    free_.pop_back();
+
+    // the chunk ends after a newline, or with the input
+    const char *begin = data_ + pos_, *end = data_ + size_;
+    if ((size_t)(end - begin) > chunk_size_) {
+        const char *newline = (const char*)memchr(begin + chunk_size_, '\n', end - begin - chunk_size_);
+        if (newline) end = newline + 1;
+    }
+    chunk = StringRef(begin, end - begin);
+    batch->seq_ = chunks_++;
+    batch->offset_ = pos_;
+    pos_ = end - data_;
+    ++busy_;
+    return true;
+}
+
+void JsonParallelReader::Work() {
+    JsonLineReader reader;
+    reader.set_parse_flags(flags_);
+    reader.set_max_depth(max_depth_);
+
+    JsonLineBatch *batch = NULL;
+    StringRef chunk;
+    while (Take(batch, chunk)) {
+        batch->doc_.reset();
+        batch->errors_.clear();
+        Json &records = batch->doc_.root();
+        records.array();
+
+        int32_t ret = 0;
+        reader.Reset(chunk);
+        while (LINES_END != (ret = reader.Next(records.emplace_back(), batch->doc_.keys()))) {
+            if (0 != ret) {
+                records.array().back().clear();
+                JsonLineBatch::Error error = { records.size() - 1, reader.line(), ret };
+                batch->errors_.push_back(error);
+            }
+        }
+        records.array().pop_back();
+        batch->lines_ = reader.line();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push_back(batch);
+            --busy_;
+        }
+        ready_cv_.notify_one();
+    }
+}
+
+const JsonLineBatch* JsonParallelReader::Next() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (current_) {
+        free_.push_back(current_);
+        current_ = NULL;
+        free_cv_.notify_one();
+    }
+
+    for (;;) {
+        if (stop_) return NULL;
+        std::vector<JsonLineBatch*>::iterator it = ready_.begin();
+        if (ORDER_INPUT == order_) {
+            while (it != ready_.end() && (*it)->seq_ != taken_) ++it;
+        }
+        if (it != ready_.end()) {
+            current_ = *it;
+            ready_.erase(it);
+            break;
+        }
+        if (pos_ >= size_ && 0 == busy_ && ready_.empty()) return NULL;
+        ready_cv_.wait(lock);
+    }
+
+    ++taken_;
+    records_ += current_->size();
+    errors_ += current_->errors_.size();
+
+    // in order, the pages before the batch are not needed anymore
+    if (ORDER_INPUT == order_ && file_.data() && current_->offset_ - released_ >= PARALLEL_RELEASE_SIZE) {
+        file_.Release(current_->offset_);
+        released_ = current_->offset_;
+    }
+    return current_;
+}
+
+JsonParallelParser::JsonParallelParser(size_t threads)
+    : chunk_size_(PARALLEL_CHUNK_SIZE), flags_(PARSE_DEFAULT), max_depth_(MAX_PARSE_DEPTH) {
+    set_threads(threads);
+}
+
+void JsonParallelParser::set_threads(size_t threads) {
+    if (0 == threads) threads = std::thread::hardware_concurrency();
+    threads_ = std::max(threads, (size_t)1);
+}
+
+int32_t JsonParallelParser::Parse(const StringRef& text, Json& json) {
+    ranges_.clear();
+    json.clear();
+
+    if (threads_ < 2 || json.get_allocator().arena() || max_depth_ < 1 ||
+        !SplitArray(text.data, text.data + text.size, chunk_size_, ranges_)) {
+        ranges_.clear();
+        return ParseOne(text, json);
+    }
+
+    Json::Array &arr = json.array();
+    if (!ranges_.empty()) arr.resize(ranges_.back().first + ranges_.back().count);
+
+    // the threads take the next range until none is left
+    std::atomic<size_t> next(0);
+    std::vector<int32_t> rets(ranges_.size(), 0);
+    std::vector<std::thread> workers;
+    const size_t threads = std::min(threads_, ranges_.size());
+    for (size_t i = 0; i < threads; ++i) {
+        workers.push_back(std::thread([&]() {
+            JsonKeyPool keys;
+            for (size_t r = next++; r < ranges_.size(); r = next++) {
+                rets[r] = ParseRange(ranges_[r], arr, keys);
+            }
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+
+    // the first error is found again as one thread would find it
+    for (size_t r = 0; r < rets.size(); ++r) {
+        if (0 != rets[r]) {
+            json.clear();
+            return ParseOne(text, json);
+        }
+    }
+    return 0;
+}
+
+// the elements of range, separated by commas
+int32_t JsonParallelParser::ParseRange(const JsonArraySpan& range, Json::Array& arr, JsonKeyPool& keys) {
+    JsonTokenzier tokenizer(range.begin, range.end);
+    JsonDomBuilder builder;
+    JsonSaxParser<JsonDomBuilder> parser(builder, flags_);
+    parser.set_max_depth(max_depth_ - 1);
+
+    for (size_t i = 0; i < range.count; ++i) {
+        builder.Reset(arr[range.first + i], &keys);
+        int32_t ret = parser.Parse(tokenizer);
+        if (0 != ret) return ret;
+
+        const JsonTokenzier::TokenType type = tokenizer.SkipCommentAndNextToken().type;
+        if (type != (i + 1 < range.count ? JsonTokenzier::TK_COMMA : JsonTokenzier::TK_EOF)) return ERR_ARRAY_END;
+    }
+    return 0;
+}
+
+int32_t JsonParallelParser::ParseOne(const StringRef& text, Json& json) {
+    JsonStream stream;
+    stream.set_parse_flags(flags_);
+    stream.set_max_depth(max_depth_);
+    return stream.Parse(text, json);
+}
+
+} //namespace jslite
@@ -0,0 +1,188 @@
+#ifndef __JS_JSON_PARALLEL_HPP_20150123__
+#define __JS_JSON_PARALLEL_HPP_20150123__
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#include "jsonlite.hpp"
+#include "json_document.hpp"
+#include "json_file.hpp"
+#include "json_simd.hpp"
+#include "json_stream.hpp"
+
+namespace jslite {
+
+typedef enum {
+    ORDER_INPUT = 0, // batches in the order of the input
+    ORDER_ANY,       // batches as soon as they are parsed
+} BatchOrder;
+
+// the records of a chunk of lines, parsed by one worker into a document of
+// the batch. a bad line is a null record with an error.
+class JsonLineBatch {
+public:
+    struct Error {
+        size_t  index;  // of the record
+        size_t  line;   // in the chunk, from 1
+        int32_t error;
+    };
+
+    JsonLineBatch() : seq_(0), offset_(0), lines_(0) {}
+
+    // an array of the records
+    const Json& records() const { return doc_.root(); }
+    size_t size() const { return doc_.root().size(); }
+    const Json& operator [] (size_t idx) const { return doc_.root()[idx]; }
+    const std::vector<Error>& errors() const { return errors_; }
+
+    size_t seq() const { return seq_; }       // of the chunk, from 0
+    size_t offset() const { return offset_; } // of the chunk in the input
+    size_t lines() const { return lines_; }   // blank ones too
+
+private:
+    friend class JsonParallelReader;
+
+    JsonLineBatch(const JsonLineBatch&);
+    JsonLineBatch& operator = (const JsonLineBatch&);
+
+    JsonDocument        doc_;
+    std::vector<Error>  errors_;
+    size_t              seq_;
+    size_t              offset_;
+    size_t              lines_;
+};
+
+// parses newline delimited json on a pool of threads. the input is cut
+// into chunks at newlines, and each worker parses a chunk with its own
+// parser into the arena of a batch. the caller takes the batches in the
+// order of the input, or in any order for the most throughput.
+//
+//   JsonParallelReader reader(4);
+//   reader.Open(path);
+//   while (const JsonLineBatch *batch = reader.Next()) {
+//       for (size_t i = 0; i < batch->size(); ++i) ... (*batch)[i]
+//   }
+//
+// batches are recycled, so at most window of them are parsed ahead of the
+// caller and memory stays about window * chunk size of records.
+class JsonParallelReader {
+public:
+    // 0 threads is one per core
+    explicit JsonParallelReader(size_t threads = 0);
+    ~JsonParallelReader();
+
+    // the text of the caller, which is not copied
+    void Reset(const StringRef& text);
+    // a file, mapped while it is read. 0 or ERR_FILE.
+    int32_t Open(const char* path);
+    // stops the workers, the batches not taken are dropped
+    void Close();
+
+    // the next batch, valid until the next call. NULL when all were taken.
+    const JsonLineBatch* Next();
+
+    // settings for the next Reset() or Open()
+    void set_threads(size_t threads);
+    void set_chunk_size(size_t bytes) { chunk_size_ = bytes ? bytes : 1; }
+    void set_order(BatchOrder order) { order_ = order; }
+    // batches parsed ahead, at least one more than the threads
+    void set_window(size_t batches) { window_ = batches; }
+    // with PARSE_ZERO_COPY or PARSE_LAZY_NUMBERS views point into the input
+    void set_parse_flags(uint32_t flags) { flags_ = flags; }
+    void set_max_depth(size_t depth) { max_depth_ = depth; }
+
+    size_t threads() const { return threads_; }
+    // of the batches taken so far
+    size_t batches() const { return taken_; }
+    size_t records() const { return records_; }
+    size_t errors() const { return errors_; }
+
+protected:
+    void Start(const char* data, size_t size);
+    void Work();
+    // the next chunk into a free batch, false when none is left
+    bool Take(JsonLineBatch*& batch, StringRef& chunk);
+
+private:
+    JsonParallelReader(const JsonParallelReader&);
+    JsonParallelReader& operator = (const JsonParallelReader&);
+
+    size_t      threads_;
+    size_t      chunk_size_;
+    size_t      window_;
+    BatchOrder  order_;
+    uint32_t    flags_;
+    size_t      max_depth_;
+
+    JsonMappedFile  file_;
+    size_t          released_; // of file_
+    const char     *data_;
+    size_t          size_;
+    size_t          pos_;      // start of the next chunk
+
+    std::vector<std::thread>    workers_;
+    std::vector<JsonLineBatch*> batches_; // all of them, reused by each run
+    std::vector<JsonLineBatch*> free_;
+    std::vector<JsonLineBatch*> ready_;   // parsed, not taken yet
+    JsonLineBatch              *current_; // taken by the caller
+    size_t                      busy_;    // batches being parsed
+    size_t                      chunks_;  // handed to the workers
+    bool                        stop_;
+    std::mutex                  mutex_;
+    std::condition_variable     free_cv_;
+    std::condition_variable     ready_cv_;
+
+    size_t taken_;
+    size_t records_;
+    size_t errors_;
+};
+
+// parses a text that is one large array, like a dump of records, on a pool
+// of threads. SplitArray() finds where the elements of the array begin,
+// and ranges of elements are parsed at the same time right into their
+// places in the array.
+//
+//   JsonParallelParser parser(4);
+//   Json records;
+//   ret = parser.Parse(file.text(), records);
+//
+// any other text, a text with comments, and a bad one are parsed by one
+// thread, so the result and the error are the ones of JsonStream.
+class JsonParallelParser {
+public:
+    // 0 threads is one per core
+    explicit JsonParallelParser(size_t threads = 0);
+
+    // json is cleared first. a value of a document is parsed by one thread,
+    // the arena is not shared between threads.
+    int32_t Parse(const StringRef& text, Json& json);
+
+    void set_threads(size_t threads);
+    // bytes of the elements parsed by a thread at once
+    void set_chunk_size(size_t bytes) { chunk_size_ = bytes ? bytes : 1; }
+    // with PARSE_ZERO_COPY or PARSE_LAZY_NUMBERS views point into the text
+    void set_parse_flags(uint32_t flags) { flags_ = flags; }
+    void set_max_depth(size_t depth) { max_depth_ = depth; }
+
+    size_t threads() const { return threads_; }
+    // ranges of the last parse, 0 if it was parsed by one thread
+    size_t ranges() const { return ranges_.size(); }
+
+protected:
+    int32_t ParseRange(const JsonArraySpan& range, Json::Array& arr, JsonKeyPool& keys);
+    int32_t ParseOne(const StringRef& text, Json& json);
+
+private:
+    size_t                      threads_;
+    size_t                      chunk_size_;
+    uint32_t                    flags_;
+    size_t                      max_depth_;
+    std::vector<JsonArraySpan>  ranges_;
+};
+
+} //namespace jslite
+
+#endif //__JS_JSON_PARALLEL_HPP_20150123__
@@ -0,0 +1,81 @@
+#include "json_parse.hpp"
+#include "json_stream.hpp"
+#include "json_util.hpp"
+#include "json_simd.hpp"
+
+namespace jslite {
+
+// characters between the quotes of a string token
+int32_t StringContent(const JsonTokenzier::Token& token, StringRef& content, bool& escaped) {
+    const char *it = token.begin;
+
+    if ('"' != *it) return ERR_QUOTES;
+
+    escaped = false;
+    for(++it; (it = ScanString(it, token.end)) != token.end && *it != '"'; ++it) {
+        if ('\\' == *it) {
+            escaped = true;
+            if (++it == token.end) break;
+        }
+    }
+
+    if (it == token.end || '"' != *it) return ERR_QUOTES;
+
+    content = StringRef(token.begin + 1, it - token.begin - 1);
+    return 0;
+}
+
+int32_t CheckEscapes(const StringRef& content) {
+    const char *end = content.data + content.size;
+    for (const char *it = content.data; it != end; ++it) {
+        if ('\\' != *it) continue;
+        switch(*++it) {
+        case '"': case '\\': case '/':
+        case 'b': case 'f': case 'n': case 'r': case 't':
+            break;
+        case 'u': //u: 2chars(json only), U:4chars
+            ++it;
+            if (std::distance(it, end) < 4) return ERR_UNICODE;
+            if (!(isxdigit(*it) && isxdigit(*(it+1)) && isxdigit(*(it+2)) && isxdigit(*(it+3)))) return ERR_UNICODE;
+            it += 3;
+            break;
+        default: return ERR_ESC_CHAR;
+        }
+    }
+    return 0;
+}
+
+int32_t ParseString(const JsonTokenzier::Token& token, std::string& str) {
+    str.clear();
+
+    StringRef content;
+    bool escaped = false;
+    int32_t ret = StringContent(token, content, escaped);
+    if (0 != ret) return ret;
+
+    if (!escaped) {
+        str.assign(content.data, content.size);
+        return 0;
+    }
+
+    ret = CheckEscapes(content);
+    if (0 != ret) return ret;
+    Unescape(content.data, content.data + content.size, str);
+
+    return 0;
+}
+
+int32_t ParseString(const JsonTokenzier::Token& token, StringRef& str, std::string& buf) {
+    bool escaped = false;
+    int32_t ret = StringContent(token, str, escaped);
+    if (0 != ret || !escaped) return ret;
+
+    ret = CheckEscapes(str);
+    if (0 != ret) return ret;
+    buf.clear();
+    Unescape(str.data, str.data + str.size, buf);
+    str = StringRef(buf.data(), buf.size());
+    return 0;
+}
+
+} //namespace jslite
@@ -0,0 +1,24 @@
+#ifndef __JS_JSON_PARSE_HPP_20150118__
+#define __JS_JSON_PARSE_HPP_20150118__
+
+#include <string>
+
+#include "jsonlite.hpp"
+#include "json_tokenizer.hpp"
+
+namespace jslite {
+
+// conversions of tokens into values, shared by the parsers. all return 0
+// or an error of ErrnoNo.
+
+// characters between the quotes of a string token
+int32_t StringContent(const JsonTokenzier::Token& token, StringRef& content, bool& escaped);
+int32_t CheckEscapes(const StringRef& content);
+
+int32_t ParseString(const JsonTokenzier::Token& token, std::string& str);
+// str refers to the token when it has no escapes, otherwise to buf
+int32_t ParseString(const JsonTokenzier::Token& token, StringRef& str, std::string& buf);
+
+} //namespace jslite
+
+#endif //__JS_JSON_PARSE_HPP_20150118__
@@ -0,0 +1,94 @@
+#include "json_projection.hpp"
+#include "json_stream.hpp"
+
+#include <string.h>
+
+namespace jslite {
+
+const JsonProjection::Node* JsonProjection::Node::Find(const StringRef& key) const {
+    const Node *any = NULL;
+    for (size_t i = 0; i < children.size(); ++i) {
+        const Node &child = children[i];
+        if ("*" == child.name) {
+            any = &child;
+        } else if (child.name.size() == key.size && 0 == memcmp(child.name.data(), key.data, key.size)) {
+            return &child;
+        }
+    }
+    return any;
+}
+
+const JsonProjection::Node* JsonProjection::Node::Find(size_t idx) const {
+    const Node *any = NULL;
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (idx == children[i].index) return &children[i];
+        if ("*" == children[i].name) any = &children[i];
+    }
+    return any;
+}
+
+// the index of an element written without leading zeros, or NO_INDEX
+static size_t ToIndex(const std::string& name) {
+    if (name.empty() || name.size() > 18 || ('0' == name[0] && name.size() > 1)) return JsonProjection::Node::NO_INDEX;
+    size_t idx = 0;
+    for (size_t i = 0; i < name.size(); ++i) {
+        if (name[i] < '0' || name[i] > '9') return JsonProjection::Node::NO_INDEX;
+        idx = idx * 10 + (name[i] - '0');
+    }
+    return idx;
+}
+
+int32_t JsonProjection::Add(const std::string& path) {
+    // "" is the whole value, every other pointer starts with '/'
+    std::vector<std::string> names;
+    if (!path.empty() && '/' != path[0]) return ERR_VALUE;
+    for (size_t pos = 0; pos < path.size(); ) {
+        std::string name;
+        for (++pos; pos < path.size() && '/' != path[pos]; ++pos) {
+            if ('~' != path[pos]) {
+                name += path[pos];
+            } else if (pos + 1 < path.size() && ('0' == path[pos + 1] || '1' == path[pos + 1])) {
+                name += ('0' == path[++pos] ? '~' : '/');
+            } else {
+                return ERR_VALUE;
+            }
+        }
+        names.push_back(name);
+    }
+
+    Insert(root_, names, 0);
+    return 0;
+}
+
+// a named child holds the paths of * as well, so the first child found for
+// a member leads to all the values kept in it
+void JsonProjection::Insert(Node& node, const std::vector<std::string>& names, size_t pos) {
+    if (node.whole) return;
+    if (pos == names.size()) {
+        node.whole = true;
+        node.children.clear();
+        return;
+    }
+
+    const std::string &name = names[pos];
+    size_t found = node.children.size(), any = node.children.size();
+    for (size_t i = 0; i < node.children.size(); ++i) {
+        if (name == node.children[i].name) found = i;
+        if ("*" == node.children[i].name) any = i;
+    }
+
+    if (found == node.children.size()) {
+        Node child = (any < node.children.size() ? node.children[any] : Node());
+        child.name = name;
+        child.index = ("*" == name ? Node::NO_INDEX : ToIndex(name));
+        node.children.push_back(child);
+    }
+
+    if ("*" == name) {
+        for (size_t i = 0; i < node.children.size(); ++i) Insert(node.children[i], names, pos + 1);
+    } else {
+        Insert(node.children[found], names, pos + 1);
+    }
+}
+
+} //namespace jslite
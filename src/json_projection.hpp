@@ -0,0 +1,60 @@
+#ifndef __JS_JSON_PROJECTION_HPP_20150124__
+#define __JS_JSON_PROJECTION_HPP_20150124__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "jsonlite.hpp"
+
+namespace jslite {
+
+// the parts of a value a parser keeps, as json pointers (RFC 6901) where *
+// stands for any member or element. the rest is skipped by counting
+// brackets (JsonTokenzier::SkipValue), without strings being unescaped,
+// numbers converted or values allocated.
+//
+//   JsonProjection projection;
+//   projection.Add("/user/id");
+//   projection.Add("/events/*/ts");
+//   stream.set_projection(&projection);
+//
+// the containers on the way to a kept value are kept, with only the
+// members and elements that lead to one. a scalar where a path goes on
+// is dropped, and elements keep their order but not their index.
+class JsonProjection {
+public:
+    struct Node {
+        Node() : index(NO_INDEX), whole(false) {}
+
+        // the child for a member or an element, NULL if none is kept
+        const Node* Find(const StringRef& key) const;
+        const Node* Find(size_t idx) const;
+
+        static const size_t NO_INDEX = (size_t)-1;
+
+        std::string         name;   // a member, an index or *
+        size_t              index;  // name as an element index
+        bool                whole;  // kept with all it contains
+        std::vector<Node>   children;
+    };
+
+    JsonProjection() {}
+
+    // 0, or ERR_VALUE for a path that is not a json pointer
+    int32_t Add(const std::string& path);
+    void clear() { root_ = Node(); }
+    bool empty() const { return !root_.whole && root_.children.empty(); }
+
+    const Node& root() const { return root_; }
+
+protected:
+    static void Insert(Node& node, const std::vector<std::string>& names, size_t pos);
+
+private:
+    Node root_;
+};
+
+} //namespace jslite
+
+#endif //__JS_JSON_PROJECTION_HPP_20150124__
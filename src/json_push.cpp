@@ -0,0 +1,419 @@
+#include "json_push.hpp"
+#include "json_document.hpp"
+#include "json_parse.hpp"
+#include "json_simd.hpp"
+#include "json_tokenizer.hpp"
+
+#include <string.h>
+#include <chrono>
+
+namespace jslite {
+
+static int64_t NowMicros() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// characters that end a number or a literal
+static bool IsDelimiter(char c) {
+    switch(c) {
+    case ' ': case '\t': case '\n': case '\v': case '\f': case '\r':
+    case '{': case '}': case '[': case ']': case ':': case ',': case '"': case '/':
+        return true;
+    default:
+        return false;
+    }
+}
+
+JsonPushParser::JsonPushParser()
+    : handler_(NULL), key_pool_(NULL), doc_keys_(NULL), state_(S_VALUE), status_(PUSH_MORE),
+      max_depth_(MAX_PARSE_DEPTH), pos_(0), rest_(NULL), rest_end_(NULL), partial_(false), escape_(false), offset_(0),
+      budget_bytes_(0), budget_micros_(0), used_(0), tokens_(0), deadline_(0) {}
+
+JsonPushParser::JsonPushParser(Json& json)
+    : handler_(NULL), key_pool_(NULL), doc_keys_(NULL), state_(S_VALUE), status_(PUSH_MORE),
+      max_depth_(MAX_PARSE_DEPTH), pos_(0), rest_(NULL), rest_end_(NULL), partial_(false), escape_(false), offset_(0),
+      budget_bytes_(0), budget_micros_(0), used_(0), tokens_(0), deadline_(0) {
+    Reset(json);
+}
+
+JsonPushParser::JsonPushParser(JsonDocument& doc)
+    : handler_(NULL), key_pool_(NULL), doc_keys_(NULL), state_(S_VALUE), status_(PUSH_MORE),
+      max_depth_(MAX_PARSE_DEPTH), pos_(0), rest_(NULL), rest_end_(NULL), partial_(false), escape_(false), offset_(0),
+      budget_bytes_(0), budget_micros_(0), used_(0), tokens_(0), deadline_(0) {
+    Reset(doc);
+}
+
+JsonPushParser::JsonPushParser(JsonHandler& handler)
+    : handler_(NULL), key_pool_(NULL), doc_keys_(NULL), state_(S_VALUE), status_(PUSH_MORE),
+      max_depth_(MAX_PARSE_DEPTH), pos_(0), rest_(NULL), rest_end_(NULL), partial_(false), escape_(false), offset_(0),
+      budget_bytes_(0), budget_micros_(0), used_(0), tokens_(0), deadline_(0) {
+    Reset(handler);
+}
+
+void JsonPushParser::Reset(Json& json) {
+    json.clear();
+    builder_.Reset(json, (key_pool_ ? key_pool_ : &keys_));
+    handler_ = &builder_;
+    doc_keys_ = NULL;
+    Restart();
+}
+
+void JsonPushParser::Reset(JsonDocument& doc) {
+    doc.reset();
+    builder_.Reset(doc.root(), &doc.keys());
+    handler_ = &builder_;
+    doc_keys_ = &doc.keys();
+    Restart();
+}
+
+void JsonPushParser::Reset(JsonHandler& handler) {
+    handler_ = &handler;
+    doc_keys_ = NULL;
+    Restart();
+}
+
+void JsonPushParser::Restart() {
+    stack_.clear();
+    state_ = S_VALUE;
+    status_ = PUSH_MORE;
+    buf_.clear();
+    pos_ = 0;
+    rest_ = rest_end_ = NULL;
+    partial_ = escape_ = false;
+    offset_ = 0;
+}
+
+void JsonPushParser::set_budget(size_t bytes, uint32_t micros) {
+    budget_bytes_ = bytes;
+    budget_micros_ = micros;
+}
+
+void JsonPushParser::set_key_pool(JsonKeyPool* pool) {
+    key_pool_ = pool;
+    if (&builder_ == handler_ && NULL == doc_keys_) builder_.set_key_pool(pool ? pool : &keys_);
+}
+
+int32_t JsonPushParser::Feed(const char* data, size_t len) {
+    if (PUSH_MORE != status_ && PUSH_PAUSED != status_) return status_;
+    if (NULL == handler_) return status_ = ERR_VALUE;
+
+    used_ = 0;
+    tokens_ = 0;
+    deadline_ = (budget_micros_ ? NowMicros() + budget_micros_ : 0);
+
+    const char *it = data, *end = data + len;
+    int32_t ret = PUSH_MORE;
+
+    if (partial_) {
+        // the rest of the token split by the last chunk
+        it = CompleteToken(it, end);
+        if (NULL == it) return status_ = PUSH_MORE;
+
+        partial_ = false;
+        const char *p = buf_.data();
+        ret = Run(p, buf_.data() + buf_.size(), true);
+        buf_.clear();
+        if (PUSH_MORE != ret) return status_ = Keep(it, end, ret);
+    } else if (rest_ && 0 == len) {
+        // a pause in the chunk of the caller goes on there
+        it = rest_;
+        end = rest_end_;
+    } else if (rest_ || pos_ < buf_.size()) {
+        // data left at a pause or an unfinished comment, which the new data
+        // goes after. what was used is dropped only when data is added.
+        if (rest_) {
+            buf_.assign(rest_, rest_end_ - rest_);
+            rest_ = rest_end_ = NULL;
+        } else if (len) {
+            buf_.erase(0, pos_);
+        }
+        if (len) {
+            pos_ = 0;
+            buf_.append(data, len);
+        }
+        const char *p = buf_.data() + pos_;
+        ret = Run(p, buf_.data() + buf_.size(), false);
+        pos_ = p - buf_.data();
+        if ((PUSH_MORE != ret && PUSH_PAUSED != ret) || pos_ == buf_.size()) {
+            buf_.clear();
+            pos_ = 0;
+        } else if (PUSH_MORE == ret) {
+            // one unfinished token, which is completed at the front of buf_
+            buf_.erase(0, pos_);
+            pos_ = 0;
+            partial_ = ('/' != buf_[0]);
+        }
+        return status_ = ret;
+    }
+
+    ret = Run(it, end, false);
+    return status_ = Keep(it, end, ret);
+}
+
+int32_t JsonPushParser::Finish() {
+    if (PUSH_MORE != status_ && PUSH_PAUSED != status_) return status_;
+    if (NULL == handler_) return status_ = ERR_VALUE;
+
+    // all of it, whatever the budget
+    used_ = 0;
+    tokens_ = 0;
+    deadline_ = 0;
+    const size_t bytes = budget_bytes_;
+    const uint32_t micros = budget_micros_;
+    budget_bytes_ = budget_micros_ = 0;
+
+    int32_t ret = PUSH_MORE;
+    if (rest_) {
+        ret = Run(rest_, rest_end_, true);
+        rest_ = rest_end_ = NULL;
+    } else if (pos_ < buf_.size()) {
+        const char *p = buf_.data() + pos_;
+        ret = Run(p, buf_.data() + buf_.size(), true);
+        buf_.clear();
+        pos_ = 0;
+        partial_ = false;
+    }
+    budget_bytes_ = bytes;
+    budget_micros_ = micros;
+
+    // the same errors as a text ending there for JsonStream
+    if (PUSH_MORE == ret) {
+        JsonTokenzier::Token eof;
+        eof.type = JsonTokenzier::TK_EOF;
+        ret = Push(eof);
+        if (PUSH_MORE == ret) ret = ERR_VALUE;
+    }
+    return status_ = ret;
+}
+
+// parses the tokens of [it, end) and moves it past the ones used. last
+// tells that no data follows end, so a token touching it is complete.
+int32_t JsonPushParser::Run(const char*& it, const char* end, bool last) {
+    const char *start = it;
+    int32_t ret = PUSH_MORE;
+
+    while (S_DONE != state_) {
+        it = SkipSpaces(it, end);
+        if (it == end) break;
+        if (OverBudget(used_ + (it - start))) {
+            ret = PUSH_PAUSED;
+            break;
+        }
+
+        const char *token_end = TokenEnd(it, end, last);
+        if (NULL == token_end) break;
+
+        JsonTokenzier tokenizer(it, token_end);
+        const JsonTokenzier::Token &token = tokenizer.NextToken();
+        ret = Push(token);
+        if (PUSH_MORE != ret && 0 != ret) break; // it stays at the wrong token
+        it = token.end;
+        ++tokens_;
+    }
+    if (S_DONE == state_) ret = 0;
+
+    used_ += it - start;
+    offset_ += it - start;
+    return ret;
+}
+
+int32_t JsonPushParser::Push(const JsonTokenzier::Token& token) {
+    if (JsonTokenzier::TK_COMMENT_C == token.type || JsonTokenzier::TK_COMMENT_CPP == token.type) return PUSH_MORE;
+
+    int32_t ret = 0;
+    bool ok = true;
+
+    switch(state_) {
+    case S_ARRAY_FIRST:
+    case S_VALUE:
+        if (S_ARRAY_FIRST == state_ && JsonTokenzier::TK_ARR_END == token.type) return Close();
+        switch(token.type) {
+        case JsonTokenzier::TK_ARR_BEGIN:
+        case JsonTokenzier::TK_OBJ_BEGIN: {
+            if (stack_.size() >= max_depth_) return ERR_OVERFLOW;
+            const Frame frame = { JsonTokenzier::TK_ARR_BEGIN == token.type, 0 };
+            if (!(frame.array ? handler_->StartArray() : handler_->StartObject())) return ERR_CANCELED;
+            stack_.push_back(frame);
+            state_ = (frame.array ? S_ARRAY_FIRST : S_OBJECT_KEY);
+            return PUSH_MORE;
+        }
+        case JsonTokenzier::TK_STRING: {
+            StringRef str;
+            ret = ParseString(token, str, str_);
+            if (0 != ret) return ret;
+            ok = handler_->String(str);
+            break;
+        }
+        case JsonTokenzier::TK_INTEGER:
+        case JsonTokenzier::TK_REAL:
+            if (!token.number.valid) return ERR_NUMBER;
+            ok = SendNumber(*handler_, token);
+            break;
+        case JsonTokenzier::TK_TRUE:
+            ok = handler_->Boolean(true);
+            break;
+        case JsonTokenzier::TK_FALSE:
+            ok = handler_->Boolean(false);
+            break;
+        case JsonTokenzier::TK_NULL:
+            ok = handler_->Null();
+            break;
+        default:
+            return ERR_VALUE;
+        }
+        if (!ok) return ERR_CANCELED;
+        return After();
+    case S_ARRAY_NEXT:
+        if (JsonTokenzier::TK_COMMA == token.type) {
+            state_ = S_VALUE;
+            return PUSH_MORE;
+        }
+        if (JsonTokenzier::TK_ARR_END == token.type) return Close();
+        return ERR_ARRAY_END;
+    case S_OBJECT_KEY: {
+        if (JsonTokenzier::TK_OBJ_END == token.type) return Close();
+        if (JsonTokenzier::TK_STRING != token.type) return ERR_OBJECT_KEY;
+
+        StringRef key;
+        ret = ParseString(token, key, str_);
+        if (0 != ret) return ret;
+        if (!handler_->Key(key)) return ERR_CANCELED;
+        state_ = S_OBJECT_COLON;
+        return PUSH_MORE;
+    }
+    case S_OBJECT_COLON:
+        if (JsonTokenzier::TK_COLON != token.type) return ERR_OBJECT_SEP;
+        state_ = S_VALUE;
+        return PUSH_MORE;
+    case S_OBJECT_NEXT:
+        if (JsonTokenzier::TK_COMMA == token.type) {
+            state_ = S_OBJECT_KEY;
+            return PUSH_MORE;
+        }
+        if (JsonTokenzier::TK_OBJ_END == token.type) return Close();
+        return ERR_OBJECT_END;
+    default:
+        return 0;
+    }
+}
+
+int32_t JsonPushParser::Close() {
+    const Frame frame = stack_.back();
+    stack_.pop_back();
+    if (!(frame.array ? handler_->EndArray(frame.count) : handler_->EndObject(frame.count))) return ERR_CANCELED;
+    return After();
+}
+
+// a value is complete
+int32_t JsonPushParser::After() {
+    if (stack_.empty()) {
+        state_ = S_DONE;
+        return 0;
+    }
+    ++stack_.back().count;
+    state_ = (stack_.back().array ? S_ARRAY_NEXT : S_OBJECT_NEXT);
+    return PUSH_MORE;
+}
+
+// end of the token at it, or NULL when the token may go on after end
+const char* JsonPushParser::TokenEnd(const char* it, const char* end, bool last) {
+    const char *p = it + 1;
+    switch(*it) {
+    case '{': case '}': case '[': case ']': case ':': case ',':
+        return p;
+    case '"':
+        escape_ = false;
+        while ((p = ScanString(p, end)) != end) {
+            if ('"' == *p) return p + 1;
+            if ('\\' == *p && ++p == end) {
+                escape_ = true;
+                break;
+            }
+            ++p;
+        }
+        break;
+    case '/':
+        if (p == end) break;
+        if ('/' == *p) {
+            for (++p; p != end; ++p) {
+                if ('\r' == *p || '\n' == *p) return p + 1;
+            }
+        } else if ('*' == *p) {
+            for (++p; p + 1 < end; ++p) {
+                if ('*' == p[0] && '/' == p[1]) return p + 2;
+            }
+        } else {
+            return p + 1;
+        }
+        break;
+    default:
+        // numbers and literals, and anything else up to a delimiter
+        for (; p != end; ++p) {
+            if (IsDelimiter(*p)) return p;
+        }
+        break;
+    }
+    return (last ? end : NULL);
+}
+
+// appends the rest of the unfinished token in buf_ from [it, end). returns
+// where the data goes on after the token, or NULL when all was taken.
+const char* JsonPushParser::CompleteToken(const char* it, const char* end) {
+    const char *p = it;
+    if ('"' == buf_[0]) {
+        if (escape_ && p != end) {
+            ++p;
+            escape_ = false;
+        }
+        while ((p = ScanString(p, end)) != end) {
+            if ('"' == *p) {
+                buf_.append(it, p + 1 - it);
+                return p + 1;
+            }
+            if ('\\' == *p && ++p == end) {
+                escape_ = true;
+                break;
+            }
+            ++p;
+        }
+    } else {
+        for (; p != end; ++p) {
+            if (IsDelimiter(*p)) {
+                buf_.append(it, p - it);
+                return p;
+            }
+        }
+    }
+    buf_.append(it, end - it);
+    return NULL;
+}
+
+// keeps what Run() left of the data of the caller. a pause keeps the range
+// itself, which Resume() goes on with. after PUSH_MORE it is one unfinished
+// token, which is copied.
+int32_t JsonPushParser::Keep(const char* it, const char* end, int32_t ret) {
+    rest_ = rest_end_ = NULL;
+    partial_ = false;
+    buf_.clear();
+    pos_ = 0;
+    if ((PUSH_MORE != ret && PUSH_PAUSED != ret) || it == end) return ret;
+
+    if (PUSH_PAUSED == ret) {
+        rest_ = it;
+        rest_end_ = end;
+    } else {
+        buf_.assign(it, end - it);
+        partial_ = ('/' != *it);
+    }
+    return ret;
+}
+
+// at least one token is parsed by each call
+bool JsonPushParser::OverBudget(size_t used) {
+    if (0 == tokens_) return false;
+    if (budget_bytes_ && used >= budget_bytes_) return true;
+    return budget_micros_ && 0 == (tokens_ & 63) && NowMicros() >= deadline_;
+}
+
+} //namespace jslite
@@ -0,0 +1,120 @@
+#ifndef __JS_JSON_PUSH_HPP_20150118__
+#define __JS_JSON_PUSH_HPP_20150118__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "jsonlite.hpp"
+#include "json_sax.hpp"
+#include "json_stream.hpp"
+#include "json_tokenizer.hpp"
+
+namespace jslite {
+
+typedef enum {
+	PUSH_MORE = -1, // all data was used, the value needs more
+	PUSH_PAUSED = -2, // stopped at the budget, Resume() goes on
+} PushStatus;
+
+// parses a text that arrives in chunks. each Feed() goes as far as its
+// data allows and keeps the state for the next one, so tokens, strings
+// and escapes may be split anywhere. the unfinished token at the end of a
+// chunk is copied. at PUSH_PAUSED the parser keeps a pointer into the
+// chunk instead, so the chunk must stay alive and unchanged until Resume()
+// is done with it or the next Feed(), which copies what is left of it.
+//
+//   JsonPushParser parser(json);
+//   while (PUSH_MORE == (ret = parser.Feed(data, len))) { ... }
+//   if (PUSH_MORE == ret) ret = parser.Finish();
+//
+// Feed(), Resume() and Finish() return 0 when the value is complete,
+// PUSH_MORE, PUSH_PAUSED or an error of ErrnoNo.
+class JsonPushParser {
+public:
+    JsonPushParser();
+    explicit JsonPushParser(Json& json);
+    explicit JsonPushParser(JsonDocument& doc);
+    explicit JsonPushParser(JsonHandler& handler);
+
+    // starts over with a new value
+    void Reset(Json& json);
+    void Reset(JsonDocument& doc); // values are allocated from doc
+    void Reset(JsonHandler& handler); // events instead of a tree
+
+    int32_t Feed(const char* data, size_t len);
+    int32_t Feed(const std::string& data) { return Feed(data.data(), data.size()); }
+    // goes on after PUSH_PAUSED, in the chunk of the pause
+    int32_t Resume() { return Feed(NULL, 0); }
+    // the end of the input, which ends a number at the end of the text
+    int32_t Finish();
+
+    // Feed() and Resume() pause after about bytes of input or micros
+    // microseconds, so an event loop can do other work in between. 0 is no
+    // limit.
+    void set_budget(size_t bytes, uint32_t micros = 0);
+    void set_key_pool(JsonKeyPool* pool);
+    void set_max_depth(size_t depth) { max_depth_ = depth; }
+
+    int32_t status() const { return status_; }
+    // bytes of input used so far, up to the end of a complete value
+    size_t offset() const { return offset_; }
+    // bytes not parsed yet, until more data comes or Resume()
+    size_t buffered() const { return rest_ ? rest_end_ - rest_ : buf_.size() - pos_; }
+
+protected:
+    typedef enum {
+        S_VALUE,         // a value
+        S_ARRAY_FIRST,   // a value or ']' after '['
+        S_ARRAY_NEXT,    // ',' or ']' after an element
+        S_OBJECT_KEY,    // a key or '}'
+        S_OBJECT_COLON,  // ':' after a key
+        S_OBJECT_NEXT,   // ',' or '}' after a member
+        S_DONE,
+    } State;
+
+    struct Frame {
+        bool   array;
+        size_t count; // values so far
+    };
+
+    void Restart();
+    int32_t Run(const char*& it, const char* end, bool last);
+    int32_t Push(const JsonTokenzier::Token& token);
+    int32_t Close();
+    int32_t After();
+    const char* TokenEnd(const char* it, const char* end, bool last);
+    const char* CompleteToken(const char* it, const char* end);
+    int32_t Keep(const char* it, const char* end, int32_t ret);
+    bool OverBudget(size_t used);
+
+private:
+    JsonHandler         *handler_;
+    JsonDomBuilder       builder_;  // the handler of Reset(Json&)
+    JsonKeyPool          keys_;
+    JsonKeyPool         *key_pool_;
+    JsonKeyPool         *doc_keys_; // of the document being parsed
+    std::vector<Frame>   stack_;    // open containers
+    State                state_;
+    int32_t              status_;
+    size_t               max_depth_;
+
+    std::string buf_;     // an unfinished token, or data fed at a pause
+    size_t      pos_;     // where parsing goes on in buf_
+    const char *rest_;    // the data left at a pause in the chunk of the caller
+    const char *rest_end_;
+    bool        partial_; // buf_ holds one unfinished string or scalar
+    bool        escape_;  // the unfinished string ends in a backslash
+    std::string str_;     // scratch for unescaped strings and keys
+
+    size_t   offset_;
+    size_t   budget_bytes_;
+    uint32_t budget_micros_;
+    size_t   used_;       // bytes used by the running call
+    uint32_t tokens_;     // tokens of the running call
+    int64_t  deadline_;   // of the running call, in microseconds
+};
+
+} //namespace jslite
+
+#endif //__JS_JSON_PUSH_HPP_20150118__
@@ -0,0 +1,71 @@
+#include "json_reader.hpp"
+#include "json_number.hpp"
+#include "json_parse.hpp"
+#include "json_stream.hpp"
+
+namespace jslite {
+
+JsonReader::JsonReader(const char* begin, const char* end)
+    : tokenizer_(begin, end) {}
+
+JsonReader::JsonReader(const StringRef& text)
+    : tokenizer_(text.data, text.data + text.size) {}
+
+JsonTokenzier::TokenType JsonReader::NextToken() {
+    return tokenizer_.SkipCommentAndNextToken().type;
+}
+
+int32_t JsonReader::GetInt64(int64_t& value) const {
+    const JsonTokenzier::Token &token = tokenizer_.CurrentToken();
+    if (JsonTokenzier::TK_INTEGER != token.type) return (JsonTokenzier::TK_REAL == token.type ? ERR_NUMBER : ERR_JSON_TYPE);
+    if (!token.number.valid) return ERR_NUMBER;
+
+    // positive integers of 10 digits or more are classified as unsigned
+    uint64_t number = 0;
+    NumberType type = ClassifyNumber(token.number, token.end, number);
+    if (NUMBER_REAL == type || (NUMBER_UINTEGER == type && number > (uint64_t)INT64_MAX)) return ERR_OVERFLOW;
+    value = (int64_t)number;
+    return 0;
+}
+
+int32_t JsonReader::GetUInt64(uint64_t& value) const {
+    const JsonTokenzier::Token &token = tokenizer_.CurrentToken();
+    if (JsonTokenzier::TK_INTEGER != token.type) return (JsonTokenzier::TK_REAL == token.type ? ERR_NUMBER : ERR_JSON_TYPE);
+    if (!token.number.valid) return ERR_NUMBER;
+    if (token.number.negative) return ERR_OVERFLOW;
+
+    uint64_t number = 0;
+    if (NUMBER_REAL == ClassifyNumber(token.number, token.end, number)) return ERR_OVERFLOW;
+    value = number;
+    return 0;
+}
+
+int32_t JsonReader::GetDouble(double& value) const {
+    const JsonTokenzier::Token &token = tokenizer_.CurrentToken();
+    if (JsonTokenzier::TK_INTEGER != token.type && JsonTokenzier::TK_REAL != token.type) return ERR_JSON_TYPE;
+    if (!token.number.valid) return ERR_NUMBER;
+
+    value = NumberToDouble(token.number, token.begin, token.end);
+    return 0;
+}
+
+int32_t JsonReader::GetBool(bool& value) const {
+    const JsonTokenzier::Token &token = tokenizer_.CurrentToken();
+    switch(token.type) {
+    case JsonTokenzier::TK_TRUE:  value = true; return 0;
+    case JsonTokenzier::TK_FALSE: value = false; return 0;
+    default: return ERR_JSON_TYPE;
+    }
+}
+
+int32_t JsonReader::GetStringView(StringRef& str) {
+    const JsonTokenzier::Token &token = tokenizer_.CurrentToken();
+    if (JsonTokenzier::TK_STRING != token.type) return ERR_JSON_TYPE;
+    return ParseString(token, str, buf_);
+}
+
+int32_t JsonReader::SkipValue() {
+    return tokenizer_.SkipValue() ? 0 : ERR_VALUE;
+}
+
+} //namespace jslite
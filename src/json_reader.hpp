@@ -0,0 +1,58 @@
+#ifndef __JS_JSON_READER_HPP_20150120__
+#define __JS_JSON_READER_HPP_20150120__
+
+#include <string>
+#include <stdint.h>
+
+#include "jsonlite.hpp"
+#include "json_tokenizer.hpp"
+
+namespace jslite {
+
+// reads the tokens of a text one at a time, without building a tree, so a
+// decoder takes the values it needs in order and skips the rest.
+//
+//   JsonReader reader(text, text + len);
+//   if (JsonTokenzier::TK_OBJ_BEGIN != reader.NextToken()) ...
+//   while (JsonTokenzier::TK_STRING == reader.NextToken()) {
+//       reader.GetStringView(key);
+//       reader.NextToken(); // ':'
+//       reader.NextToken();
+//       if (key == "id") reader.GetInt64(id); else reader.SkipValue();
+//       if (JsonTokenzier::TK_COMMA != reader.NextToken()) break;
+//   }
+//
+// the getters read the current token and return 0 or an error of ErrnoNo.
+// nothing is allocated but the buffer of escaped strings.
+class JsonReader {
+public:
+    JsonReader(const char* begin, const char* end);
+    explicit JsonReader(const StringRef& text);
+
+    // the next token with comments skipped, TK_EOF at the end of the text
+    JsonTokenzier::TokenType NextToken();
+    JsonTokenzier::TokenType type() const { return token().type; }
+    const JsonTokenzier::Token& token() const { return tokenizer_.CurrentToken(); }
+
+    int32_t GetInt64(int64_t& value) const;
+    int32_t GetUInt64(uint64_t& value) const;
+    int32_t GetDouble(double& value) const;
+    int32_t GetBool(bool& value) const;
+    bool IsNull() const { return JsonTokenzier::TK_NULL == type(); }
+
+    // str refers to the text, or to a buffer of the reader for escaped
+    // strings which is valid until the next GetStringView()
+    int32_t GetStringView(StringRef& str);
+
+    // goes past the value that starts at the current token, which becomes
+    // the last token of the value. only brackets are matched inside it.
+    int32_t SkipValue();
+
+private:
+    JsonTokenzier tokenizer_;
+    std::string   buf_; // escaped strings
+};
+
+} //namespace jslite
+
+#endif //__JS_JSON_READER_HPP_20150120__
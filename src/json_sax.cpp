@@ -0,0 +1,27 @@
+#include "json_sax.hpp"
+#include "json_util.hpp"
+
+namespace jslite {
+
+bool JsonHandler::RawString(const StringRef& str, bool escaped) {
+    if (!escaped) return String(str);
+
+    buf_.clear();
+    Unescape(str.data, str.data + str.size, buf_);
+    return String(StringRef(buf_.data(), buf_.size()));
+}
+
+bool JsonHandler::Number(const StringRef& text) {
+    JsonNumber number;
+    uint64_t value = 0;
+    const char *end = text.data + text.size;
+    ScanNumber(text.data, end, number);
+
+    switch(ClassifyNumber(number, end, value)) {
+    case NUMBER_INTEGER:  return Integer((int64_t)value);
+    case NUMBER_UINTEGER: return UInteger(value);
+    default: return Real(NumberToDouble(number, text.data, end));
+    }
+}
+
+} //namespace jslite
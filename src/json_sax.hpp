@@ -0,0 +1,336 @@
+#ifndef __JS_JSON_SAX_HPP_20150119__
+#define __JS_JSON_SAX_HPP_20150119__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "jsonlite.hpp"
+#include "json_number.hpp"
+#include "json_parse.hpp"
+#include "json_projection.hpp"
+#include "json_simd.hpp"
+#include "json_stream.hpp"
+#include "json_tokenizer.hpp"
+
+namespace jslite {
+
+// receives the values of a text in the order they are parsed, without a
+// tree being built. a callback returning false stops the parse with
+// ERR_CANCELED. strings and keys are valid only during the call.
+//
+// the defaults accept everything, so a handler overrides only what it
+// needs.
+class JsonHandler {
+public:
+    virtual ~JsonHandler() {}
+
+    virtual bool Null() { return true; }
+    virtual bool Boolean(bool /*value*/) { return true; }
+    virtual bool Integer(int64_t /*value*/) { return true; }
+    virtual bool UInteger(uint64_t /*value*/) { return true; }
+    virtual bool Real(double /*value*/) { return true; }
+    virtual bool String(const StringRef& /*str*/) { return true; }
+    virtual bool StartObject() { return true; }
+    virtual bool Key(const StringRef& /*key*/) { return true; }
+    virtual bool EndObject(size_t /*members*/) { return true; }
+    virtual bool StartArray() { return true; }
+    virtual bool EndArray(size_t /*elements*/) { return true; }
+
+    // with PARSE_ZERO_COPY, strings as they are in the text. the default
+    // unescapes them for String().
+    virtual bool RawString(const StringRef& str, bool escaped);
+    // with PARSE_LAZY_NUMBERS, the text of numbers with a valid syntax. the
+    // default converts them for Integer(), UInteger() or Real().
+    virtual bool Number(const StringRef& text);
+
+private:
+    std::string buf_;
+};
+
+// the handler building the Json tree of JsonStream::Parse()
+class JsonDomBuilder final : public JsonHandler {
+public:
+    JsonDomBuilder() : root_(NULL), member_(NULL), keys_(NULL), sizes_(NULL), next_size_(0) {}
+    explicit JsonDomBuilder(Json& root, JsonKeyPool* keys = NULL)
+        : root_(&root), member_(NULL), keys_(keys), sizes_(NULL), next_size_(0) {}
+
+    // starts over with a new tree
+    void Reset(Json& root, JsonKeyPool* keys = NULL) {
+        root_ = &root;
+        member_ = NULL;
+        keys_ = keys;
+        sizes_ = NULL;
+        next_size_ = 0;
+        stack_.clear();
+    }
+
+    void set_key_pool(JsonKeyPool* keys) { keys_ = keys; }
+
+    // sizes of arrays in the order they begin, reserved when they do
+    void set_array_sizes(const std::vector<uint32_t>* sizes) {
+        sizes_ = sizes;
+        next_size_ = 0;
+    }
+
+    bool Null() { Next(); return true; }
+    bool Boolean(bool value) { *Next() = value; return true; }
+    bool Integer(int64_t value) { *Next() = (Json::Integer)value; return true; }
+    bool UInteger(uint64_t value) { *Next() = (Json::UInteger)value; return true; }
+    bool Real(double value) { *Next() = value; return true; }
+    bool String(const StringRef& str) { Next()->assign(str.data, str.size); return true; }
+    bool RawString(const StringRef& str, bool escaped) { Next()->assign_view(str.data, str.size, escaped); return true; }
+    bool Number(const StringRef& text) { Next()->assign_number(text.data, text.size); return true; }
+
+    bool StartObject() {
+        Json *value = Next();
+        value->object();
+        stack_.push_back(value);
+        return true;
+    }
+
+    // keys are interned into the pool when they can be
+    bool Key(const StringRef& key) {
+        JsonKey interned;
+        if (keys_) interned = keys_->Intern(key);
+
+        Json::Object &obj = stack_.back()->object();
+        if (interned.empty()) {
+            key_.assign(key.data, key.size);
+            member_ = &obj.emplace(key_, Json()).first->second;
+        } else {
+            member_ = &obj.emplace(interned, Json()).first->second;
+        }
+        member_->clear(); // the last one wins on duplicated keys
+        return true;
+    }
+
+    bool EndObject(size_t /*members*/) { stack_.pop_back(); return true; }
+
+    bool StartArray() {
+        Json *value = Next();
+        value->array();
+        if (sizes_ && next_size_ < sizes_->size()) value->reserve((*sizes_)[next_size_++]);
+        stack_.push_back(value);
+        return true;
+    }
+
+    bool EndArray(size_t /*elements*/) { stack_.pop_back(); return true; }
+
+protected:
+    // the value a callback fills: the root, the next element of an array
+    // or the member of the last key
+    Json* Next() {
+        if (stack_.empty()) return root_;
+        Json *top = stack_.back();
+        return (top->IsArray() ? &top->emplace_back() : member_);
+    }
+
+private:
+    Json                            *root_;
+    Json                            *member_;
+    JsonKeyPool                     *keys_;
+    const std::vector<uint32_t>     *sizes_;
+    size_t                           next_size_;
+    std::vector<Json*>               stack_; // open containers
+    std::string                      key_;   // keys not interned
+};
+
+// passes a number token to the handler
+template <class Handler>
+bool SendNumber(Handler& handler, const JsonTokenzier::Token& token) {
+    uint64_t value = 0;
+    switch(ClassifyNumber(token.number, token.end, value)) {
+    case NUMBER_INTEGER:  return handler.Integer((int64_t)value);
+    case NUMBER_UINTEGER: return handler.UInteger(value);
+    default: return handler.Real(NumberToDouble(token.number, token.begin, token.end));
+    }
+}
+
+// drives a handler from the tokens of a text. the handler is a template
+// parameter, so its callbacks are inlined; JsonSaxParser<JsonHandler>
+// calls them through the virtual functions.
+//
+// the open containers are kept on a stack of its own instead of the call
+// stack, so a deep text takes no more of the thread stack than a flat one.
+template <class Handler>
+class JsonSaxParser {
+public:
+    explicit JsonSaxParser(Handler& handler, uint32_t flags = PARSE_DEFAULT)
+        : handler_(&handler), flags_(flags), max_depth_(MAX_PARSE_DEPTH), projection_(NULL), node_(NULL) {}
+
+    // one value of [begin, end). with PARSE_ZERO_COPY or PARSE_LAZY_NUMBERS
+    // the views passed to the handler point into it.
+    int32_t Parse(const char* begin, const char* end) {
+        JsonTokenzier tokenizer(begin, end);
+        if ((flags_ & PARSE_STRUCTURAL_INDEX) && index_.Build(begin, end)) {
+            tokenizer.set_index(index_.data(), index_.size());
+        }
+        return Parse(tokenizer);
+    }
+
+    int32_t Parse(JsonTokenzier& tokenizer) {
+        const JsonTokenzier::Token &token = tokenizer.CurrentToken();
+        int32_t ret = 0;
+        stack_.clear();
+        node_ = (projection_ && !projection_->empty() && !projection_->root().whole ? &projection_->root() : NULL);
+
+        tokenizer.SkipCommentAndNextToken();
+    value_token:
+        switch(token.type) {
+        case JsonTokenzier::TK_ARR_BEGIN:
+            if (stack_.size() >= max_depth_) return ERR_OVERFLOW;
+            if (!handler_->StartArray()) return ERR_CANCELED;
+            stack_.push_back(Frame(true, node_));
+            if (JsonTokenzier::TK_ARR_END == tokenizer.SkipCommentAndNextToken().type) goto close;
+            goto element;
+        case JsonTokenzier::TK_OBJ_BEGIN:
+            if (stack_.size() >= max_depth_) return ERR_OVERFLOW;
+            if (!handler_->StartObject()) return ERR_CANCELED;
+            stack_.push_back(Frame(false, node_));
+            goto key;
+        case JsonTokenzier::TK_STRING:
+            ret = ParseString(token);
+            break;
+        case JsonTokenzier::TK_INTEGER:
+        case JsonTokenzier::TK_REAL:
+            ret = ParseNumber(token);
+            break;
+        case JsonTokenzier::TK_TRUE:
+            ret = (handler_->Boolean(true) ? 0 : ERR_CANCELED);
+            break;
+        case JsonTokenzier::TK_FALSE:
+            ret = (handler_->Boolean(false) ? 0 : ERR_CANCELED);
+            break;
+        case JsonTokenzier::TK_NULL:
+            ret = (handler_->Null() ? 0 : ERR_CANCELED);
+            break;
+        default:
+            return ERR_VALUE;
+        }
+        if (0 != ret) return ret;
+
+    after: // a value is complete
+        if (stack_.empty()) return 0;
+        ++stack_.back().count;
+    next: // or skipped
+        tokenizer.SkipCommentAndNextToken();
+        if (stack_.back().array) {
+            if (JsonTokenzier::TK_COMMA == token.type) {
+                tokenizer.SkipCommentAndNextToken();
+                goto element;
+            }
+            if (JsonTokenzier::TK_ARR_END == token.type) goto close;
+            return ERR_ARRAY_END;
+        }
+        if (JsonTokenzier::TK_COMMA == token.type) goto key;
+        if (JsonTokenzier::TK_OBJ_END == token.type) goto close;
+        return ERR_OBJECT_END;
+
+    element: // the token begins an element of the array on the top
+        if (stack_.back().node) {
+            Frame &frame = stack_.back();
+            if (!Select(frame.node->Find(frame.index++), token.type)) {
+                if (!tokenizer.SkipValue()) return ERR_VALUE;
+                goto next;
+            }
+        }
+        goto value_token;
+
+    key: // or the end of the object
+        tokenizer.SkipCommentAndNextToken();
+        if (JsonTokenzier::TK_OBJ_END == token.type) goto close;
+        if (JsonTokenzier::TK_STRING != token.type) return ERR_OBJECT_KEY;
+        {
+            StringRef key;
+            ret = jslite::ParseString(token, key, buf_);
+            if (0 != ret) return ret;
+            if (JsonTokenzier::TK_COLON != tokenizer.SkipCommentAndNextToken().type) return ERR_OBJECT_SEP;
+            tokenizer.SkipCommentAndNextToken();
+
+            if (stack_.back().node && !Select(stack_.back().node->Find(key), token.type)) {
+                if (!tokenizer.SkipValue()) return ERR_VALUE;
+                goto next;
+            }
+            if (!handler_->Key(key)) return ERR_CANCELED;
+        }
+        goto value_token;
+
+    close: // the container on the top ends
+        {
+            const Frame frame = stack_.back();
+            stack_.pop_back();
+            if (!(frame.array ? handler_->EndArray(frame.count) : handler_->EndObject(frame.count))) return ERR_CANCELED;
+        }
+        goto after;
+    }
+
+    // the handler of the parses that follow, which keep the stack and the
+    // buffers of this parser
+    void set_handler(Handler& handler) { handler_ = &handler; }
+    void set_parse_flags(uint32_t flags) { flags_ = flags; }
+    // containers deeper than depth are ERR_OVERFLOW
+    void set_max_depth(size_t depth) { max_depth_ = depth; }
+    // only the values of projection are passed to the handler, NULL for all
+    void set_projection(const JsonProjection* projection) { projection_ = projection; }
+
+protected:
+    struct Frame {
+        Frame(bool a, const JsonProjection::Node* n) : array(a), count(0), index(0), node(n) {}
+        bool                        array;
+        size_t                      count; // values so far
+        size_t                      index; // elements so far, skipped ones too
+        const JsonProjection::Node *node;  // of the container, NULL keeps all
+    };
+
+    // whether a value beginning with type is kept for child, which becomes
+    // the node of the value
+    bool Select(const JsonProjection::Node* child, JsonTokenzier::TokenType type) {
+        if (NULL == child) return false;
+        if (child->whole) {
+            node_ = NULL;
+            return true;
+        }
+        node_ = child;
+        return JsonTokenzier::TK_OBJ_BEGIN == type || JsonTokenzier::TK_ARR_BEGIN == type;
+    }
+
+    int32_t ParseString(const JsonTokenzier::Token& token) {
+        int32_t ret = 0;
+        if (flags_ & PARSE_ZERO_COPY) {
+            StringRef content;
+            bool escaped = false;
+            ret = StringContent(token, content, escaped);
+            if (0 != ret) return ret;
+            if (escaped && 0 != (ret = CheckEscapes(content))) return ret;
+            return (handler_->RawString(content, escaped) ? 0 : ERR_CANCELED);
+        }
+
+        StringRef str;
+        ret = jslite::ParseString(token, str, buf_);
+        if (0 != ret) return ret;
+        return (handler_->String(str) ? 0 : ERR_CANCELED);
+    }
+
+    int32_t ParseNumber(const JsonTokenzier::Token& token) {
+        if (!token.number.valid) return ERR_NUMBER;
+        if (flags_ & PARSE_LAZY_NUMBERS) {
+            return (handler_->Number(StringRef(token.begin, token.end - token.begin)) ? 0 : ERR_CANCELED);
+        }
+        return (SendNumber(*handler_, token) ? 0 : ERR_CANCELED);
+    }
+
+private:
+    Handler                     *handler_;
+    uint32_t                     flags_;
+    size_t                       max_depth_;
+    std::vector<Frame>           stack_;  // open containers
+    const JsonProjection        *projection_;
+    const JsonProjection::Node  *node_;   // of the value being parsed
+    JsonStructuralIndex          index_;
+    std::string                  buf_;    // scratch for unescaped strings
+};
+
+} //namespace jslite
+
+#endif //__JS_JSON_SAX_HPP_20150119__
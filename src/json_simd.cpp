@@ -0,0 +1,495 @@
+#include "json_simd.hpp"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define JS_SIMD_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(JS_SIMD_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define JS_SIMD_SSE2
+#endif
+
+#if defined(JS_SIMD_X86) && (defined(__GNUC__) || defined(_MSC_VER))
+#define JS_SIMD_AVX2
+#if defined(__GNUC__)
+#define JS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define JS_TARGET_AVX2
+#endif
+#endif
+
+namespace jslite {
+
+namespace {
+
+// character classes of a 64 byte block, one bit per byte
+struct Block {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t space;
+    uint64_t op; // { } [ ] : ,
+    uint64_t open; // { [
+    uint64_t close; // } ]
+    uint64_t slash;
+    uint64_t nul;
+};
+
+typedef void (*Classify)(const uint8_t* p, Block& block);
+
+void ClassifyScalar(const uint8_t* p, Block& block) {
+    memset(&block, 0, sizeof(block));
+    for (int i = 0; i < 64; ++i) {
+        uint64_t bit = (uint64_t)1 << i;
+        switch(p[i]) {
+        case '"':  block.quote |= bit; break;
+        case '\\': block.backslash |= bit; break;
+        case ' ': case '\t': case '\n': case '\v': case '\f': case '\r':
+            block.space |= bit;
+            break;
+        case '{': case '[':
+            block.op |= bit;
+            block.open |= bit;
+            break;
+        case '}': case ']':
+            block.op |= bit;
+            block.close |= bit;
+            break;
+        case ':': case ',':
+            block.op |= bit;
+            break;
+        case '/':  block.slash |= bit; break;
+        case '\0': block.nul |= bit; break;
+        default: break;
+        }
+    }
+}
+
+#ifdef JS_SIMD_SSE2
+inline uint64_t Mask16(__m128i v) { return (uint64_t)(uint16_t)_mm_movemask_epi8(v); }
+
+void ClassifySse2(const uint8_t* p, Block& block) {
+    memset(&block, 0, sizeof(block));
+    for (int i = 0; i < 4; ++i) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+        const int shift = 16 * i;
+
+        // '[' and ']' become '{' and '}' with 0x20 set
+        const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        const __m128i open = _mm_cmpeq_epi8(lower, _mm_set1_epi8('{'));
+        const __m128i close = _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'));
+        const __m128i op = _mm_or_si128(_mm_or_si128(open, close),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+
+        // '\t' to '\r' are 9 to 13
+        const __m128i ctrl = _mm_sub_epi8(v, _mm_set1_epi8(9));
+        const __m128i space = _mm_or_si128(
+            _mm_cmpeq_epi8(_mm_min_epu8(ctrl, _mm_set1_epi8(4)), ctrl),
+            _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+
+        block.quote |= Mask16(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << shift;
+        block.backslash |= Mask16(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << shift;
+        block.space |= Mask16(space) << shift;
+        block.op |= Mask16(op) << shift;
+        block.open |= Mask16(open) << shift;
+        block.close |= Mask16(close) << shift;
+        block.slash |= Mask16(_mm_cmpeq_epi8(v, _mm_set1_epi8('/'))) << shift;
+        block.nul |= Mask16(_mm_cmpeq_epi8(v, _mm_setzero_si128())) << shift;
+    }
+}
+#endif
+
+#ifdef JS_SIMD_AVX2
+JS_TARGET_AVX2 inline uint64_t Mask32(__m256i v) { return (uint64_t)(uint32_t)_mm256_movemask_epi8(v); }
+
+JS_TARGET_AVX2 void ClassifyAvx2(const uint8_t* p, Block& block) {
+    memset(&block, 0, sizeof(block));
+    for (int i = 0; i < 2; ++i) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * i));
+        const int shift = 32 * i;
+
+        const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        const __m256i open = _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{'));
+        const __m256i close = _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'));
+        const __m256i op = _mm256_or_si256(_mm256_or_si256(open, close),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+
+        const __m256i ctrl = _mm256_sub_epi8(v, _mm256_set1_epi8(9));
+        const __m256i space = _mm256_or_si256(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(ctrl, _mm256_set1_epi8(4)), ctrl),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+
+        block.quote |= Mask32(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))) << shift;
+        block.backslash |= Mask32(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))) << shift;
+        block.space |= Mask32(space) << shift;
+        block.op |= Mask32(op) << shift;
+        block.open |= Mask32(open) << shift;
+        block.close |= Mask32(close) << shift;
+        block.slash |= Mask32(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'))) << shift;
+        block.nul |= Mask32(_mm256_cmpeq_epi8(v, _mm256_setzero_si256())) << shift;
+    }
+}
+#endif
+
+SimdLevel DetectLevel() {
+#if defined(JS_SIMD_AVX2) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+#elif defined(JS_SIMD_AVX2) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuidex(info, 7, 0);
+        bool avx2 = 0 != (info[1] & (1 << 5));
+        __cpuid(info, 1);
+        bool osxsave = 0 != (info[2] & (1 << 27));
+        if (avx2 && osxsave && 6 == (_xgetbv(0) & 6)) return SIMD_AVX2;
+    }
+#endif
+#ifdef JS_SIMD_SSE2
+    return SIMD_SSE2;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+// the classifier of level, lowered to what the cpu supports
+Classify ClassifyOf(SimdLevel level) {
+    if (level > simd_level()) level = simd_level();
+#ifdef JS_SIMD_AVX2
+    if (SIMD_AVX2 == level) return ClassifyAvx2;
+#endif
+#ifdef JS_SIMD_SSE2
+    if (SIMD_SSE2 == level) return ClassifySse2;
+#endif
+    return ClassifyScalar;
+}
+
+// xor of all bits up to each bit, which turns quotes into string regions
+inline uint64_t PrefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// characters escaped by a backslash. carry tells that the last byte of the
+// previous block escapes the first byte of this one.
+inline uint64_t Escaped(uint64_t backslash, uint64_t& carry) {
+    uint64_t escaped = carry;
+    backslash &= ~carry;
+    carry = 0;
+    while (backslash) {
+        uint64_t bit = backslash & (0 - backslash);
+        if (bit >> 63) {
+            carry = 1;
+        } else {
+            escaped |= bit << 1;
+        }
+        backslash &= ~(bit | (bit << 1));
+    }
+    return escaped;
+}
+
+inline int TrailingZeros(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return (int)idx;
+#else
+    int n = 0;
+    while (!(x & 1)) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+inline int PopCount(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// ' ' and '\t' to '\r', like isspace() of the "C" locale
+inline bool IsSpace(uint8_t c) { return ' ' == c || (c - 9u) < 5u; }
+
+inline bool IsStringStop(uint8_t c) { return '"' == c || '\\' == c || c < 0x20; }
+
+#ifdef JS_SIMD_SSE2
+inline int StringStops16(const char* p) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i stop = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+        _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1F)), v));
+    return _mm_movemask_epi8(stop);
+}
+
+inline int NonSpaces16(const char* p) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i ctrl = _mm_sub_epi8(v, _mm_set1_epi8(9));
+    const __m128i space = _mm_or_si128(
+        _mm_cmpeq_epi8(_mm_min_epu8(ctrl, _mm_set1_epi8(4)), ctrl),
+        _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+    return ~_mm_movemask_epi8(space) & 0xFFFF;
+}
+#endif
+
+#ifdef JS_SIMD_AVX2
+JS_TARGET_AVX2 const char* ScanStringAvx2(const char* it, const char* end) {
+    for (; end - it >= 32; it += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+        const __m256i stop = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1F)), v));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(stop);
+        if (mask) return it + TrailingZeros(mask);
+    }
+    return it;
+}
+
+JS_TARGET_AVX2 const char* SkipSpacesAvx2(const char* it, const char* end) {
+    for (; end - it >= 32; it += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+        const __m256i ctrl = _mm256_sub_epi8(v, _mm256_set1_epi8(9));
+        const __m256i space = _mm256_or_si256(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(ctrl, _mm256_set1_epi8(4)), ctrl),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+        uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(space);
+        if (mask) return it + TrailingZeros(mask);
+    }
+    return it;
+}
+#endif
+
+} // namespace
+
+SimdLevel simd_level() {
+    static const SimdLevel level = DetectLevel();
+    return level;
+}
+
+// strings and runs of spaces are mostly short, so the first bytes are
+// looked at one by one before the wider loads.
+const char* ScanString(const char* it, const char* end) {
+    for (int i = 0; i < 4 && it != end; ++i, ++it) {
+        if (IsStringStop(*it)) return it;
+    }
+#ifdef JS_SIMD_AVX2
+    static const bool avx2 = SIMD_AVX2 == simd_level();
+    if (avx2 && end - it >= 32) {
+        it = ScanStringAvx2(it, end);
+        if (end - it >= 32) return it;
+    }
+#endif
+#ifdef JS_SIMD_SSE2
+    for (; end - it >= 16; it += 16) {
+        int mask = StringStops16(it);
+        if (mask) return it + TrailingZeros(mask);
+    }
+#endif
+    for (; it != end && !IsStringStop(*it); ++it);
+    return it;
+}
+
+const char* SkipSpaces(const char* it, const char* end) {
+    for (int i = 0; i < 4 && it != end; ++i, ++it) {
+        if (!IsSpace(*it)) return it;
+    }
+#ifdef JS_SIMD_AVX2
+    static const bool avx2 = SIMD_AVX2 == simd_level();
+    if (avx2 && end - it >= 32) {
+        it = SkipSpacesAvx2(it, end);
+        if (end - it >= 32) return it;
+    }
+#endif
+#ifdef JS_SIMD_SSE2
+    for (; end - it >= 16; it += 16) {
+        int mask = NonSpaces16(it);
+        if (mask) return it + TrailingZeros(mask);
+    }
+#endif
+    for (; it != end && IsSpace(*it); ++it);
+    return it;
+}
+
+bool JsonStructuralIndex::Build(const char* begin, const char* end, SimdLevel level) {
+    size_ = 0;
+
+    const size_t len = end - begin;
+    if (len >= UINT32_MAX) return false;
+
+    Classify classify = ClassifyOf(level);
+
+    uint64_t escape_carry = 0; // the previous block ends with an escaping backslash
+    uint64_t string_carry = 0; // all ones when the previous block ends in a string
+    uint64_t scalar_carry = 0; // the previous block ends in a number or literal
+    uint8_t tail[64];
+    Block block;
+    bool indexed = true;
+
+    for (size_t pos = 0; pos < len; pos += 64) {
+        const uint8_t *p = reinterpret_cast<const uint8_t*>(begin) + pos;
+        if (len - pos < 64) {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, p, len - pos);
+            p = tail;
+        }
+        classify(p, block);
+        if (block.nul) {
+            indexed = false;
+            break;
+        }
+
+        // a string covers its opening quote and characters, not the closing quote
+        uint64_t quote = block.quote & ~Escaped(block.backslash, escape_carry);
+        uint64_t string = PrefixXor(quote) ^ string_carry;
+        string_carry = (uint64_t)((int64_t)string >> 63);
+
+        // comments and stray backslashes are left to the scalar tokenizer
+        if ((block.slash | block.backslash) & ~string) {
+            indexed = false;
+            break;
+        }
+
+        // numbers and literals begin after a space, an operator or a quote
+        uint64_t scalar = ~(block.space | block.op | block.quote | string);
+        uint64_t bits = (block.op & ~string) | quote | (scalar & ~((scalar << 1) | scalar_carry));
+        scalar_carry = scalar >> 63;
+
+        if (positions_.size() < size_ + 64) positions_.resize(positions_.size() * 2 + 64);
+        uint32_t *out = &positions_[size_];
+        for (; bits; bits &= bits - 1) *out++ = (uint32_t)(pos + TrailingZeros(bits));
+        size_ = out - &positions_[0];
+    }
+
+    if (!indexed || string_carry) {
+        size_ = 0;
+        return false;
+    }
+    return true;
+}
+
+bool SplitArray(const char* begin, const char* end, size_t span_size,
+                std::vector<JsonArraySpan>& spans, SimdLevel level) {
+    spans.clear();
+    const char *it = SkipSpaces(begin, end);
+    if (it == end || '[' != *it) return false;
+
+    Classify classify = ClassifyOf(level);
+    uint64_t escape_carry = 0;
+    uint64_t string_carry = 0;
+    uint8_t tail[64];
+    Block block;
+
+    JsonArraySpan span = { it + 1, NULL, 0, 0 };
+    size_t depth = 0; // of the containers in the array
+    for (const char *block_begin = it + 1; block_begin < end; block_begin += 64) {
+        const uint8_t *p = reinterpret_cast<const uint8_t*>(block_begin);
+        if (end - block_begin < 64) {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, p, end - block_begin);
+            p = tail;
+        }
+        classify(p, block);
+
+        uint64_t quote = block.quote & ~Escaped(block.backslash, escape_carry);
+        uint64_t string = PrefixXor(quote) ^ string_carry;
+        string_carry = (uint64_t)((int64_t)string >> 63);
+        if ((block.slash | block.nul) & ~string) return false; // comments may hide anything
+
+        for (uint64_t bits = block.op & ~string; bits; bits &= bits - 1) {
+            const char *op = block_begin + TrailingZeros(bits);
+            switch(*op) {
+            case '[': case '{':
+                ++depth;
+                break;
+            case ']': case '}':
+                if (depth) {
+                    --depth;
+                    break;
+                }
+                if (']' != *op) return false;
+                // after a comma an element must follow
+                if (span.first + span.count || SkipSpaces(span.begin, op) != op) {
+                    span.end = op;
+                    ++span.count;
+                    spans.push_back(span);
+                }
+                return SkipSpaces(op + 1, end) == end;
+            case ',':
+                if (depth) break;
+                ++span.count;
+                if ((size_t)(op - span.begin) >= span_size) {
+                    span.end = op;
+                    spans.push_back(span);
+                    span.begin = op + 1;
+                    span.first += span.count;
+                    span.count = 0;
+                }
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+const char* SkipContainer(const char* it, const char* end, SimdLevel level) {
+    Classify classify = ClassifyOf(level);
+    uint64_t escape_carry = 0;
+    uint64_t string_carry = 0;
+    uint8_t tail[64];
+    Block block;
+
+    size_t depth = 1;
+    for (const char *block_begin = it; block_begin < end; block_begin += 64) {
+        const uint8_t *p = reinterpret_cast<const uint8_t*>(block_begin);
+        if (end - block_begin < 64) {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, p, end - block_begin);
+            p = tail;
+        }
+        classify(p, block);
+
+        uint64_t quote = block.quote & ~Escaped(block.backslash, escape_carry);
+        uint64_t string = PrefixXor(quote) ^ string_carry;
+        string_carry = (uint64_t)((int64_t)string >> 63);
+        // comments may hide anything, but only those before the end count
+        const uint64_t stop = (block.slash & ~string) | block.nul;
+
+        // a block with fewer closing brackets than open containers is
+        // counted as a whole
+        const uint64_t open = block.open & ~string, close = block.close & ~string;
+        const size_t closes = PopCount(close);
+        if (depth > closes) {
+            if (stop) return NULL;
+            depth += PopCount(open) - closes;
+            continue;
+        }
+        for (uint64_t bits = open | close; bits; bits &= bits - 1) {
+            const uint64_t bit = bits & (0 - bits);
+            if (open & bit) {
+                ++depth;
+            } else if (0 == --depth) {
+                return (stop & (bit - 1)) ? NULL : block_begin + TrailingZeros(bit) + 1;
+            }
+        }
+        if (stop) return NULL;
+    }
+    return NULL;
+}
+
+} // namespace jslite
@@ -0,0 +1,71 @@
+#ifndef __JS_JSON_SIMD_HPP_20150112__
+#define __JS_JSON_SIMD_HPP_20150112__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace jslite {
+
+typedef enum {
+    SIMD_SCALAR = 0,
+    SIMD_SSE2,
+    SIMD_AVX2,
+} SimdLevel;
+
+// the best level the running cpu supports
+SimdLevel simd_level();
+
+// first quote, backslash or control character of [it, end), or end
+const char* ScanString(const char* it, const char* end);
+
+// first character of [it, end) that is not a space, or end
+const char* SkipSpaces(const char* it, const char* end);
+
+// positions of all tokens of a text and of the closing quotes of strings,
+// found 64 bytes at a time. the tokenizer jumps from one to the next
+// instead of reading the bytes in between.
+//
+// a text with comments, NUL characters, a backslash outside of strings or
+// an unterminated string is not indexed and left to the scalar tokenizer.
+class JsonStructuralIndex {
+public:
+    JsonStructuralIndex() : size_(0) {}
+
+    // level is lowered to what the cpu supports
+    bool Build(const char* begin, const char* end, SimdLevel level = simd_level());
+    void clear() { size_ = 0; }
+
+    const uint32_t* data() const { return size_ ? &positions_[0] : NULL; }
+    size_t size() const { return size_; }
+
+private:
+    std::vector<uint32_t> positions_;
+    size_t                size_;
+};
+
+// elements of an array, separated by commas
+struct JsonArraySpan {
+    const char *begin; // of the first element
+    const char *end;   // after the last one
+    size_t      first; // index of the first element in the array
+    size_t      count;
+};
+
+// cuts the elements of a text that is one array into spans of about
+// span_size bytes, following strings and brackets 64 bytes at a time. an
+// element is not checked but for where it ends, so it may still be bad.
+// false for any other text, and for one with comments or NUL characters
+// outside of strings.
+bool SplitArray(const char* begin, const char* end, size_t span_size,
+                std::vector<JsonArraySpan>& spans, SimdLevel level = simd_level());
+
+// the end of a container whose opening bracket is right before it: the
+// position after the matching closing bracket, found by counting brackets
+// outside of strings 64 bytes at a time. only brackets are matched. NULL
+// when the text ends first, or has a comment or a NUL character before.
+const char* SkipContainer(const char* it, const char* end, SimdLevel level = simd_level());
+
+} // namespace jslite
+
+#endif //__JS_JSON_SIMD_HPP_20150112__
@@ -1,12 +1,15 @@
 #include "json_stream.hpp"
 #include "json_util.hpp"
 #include "json_tokenizer.hpp"
+#include "json_document.hpp"
+#include "json_parse.hpp"
+#include "json_sax.hpp"
 #include <ostream>
+#include <vector>
+#include <algorithm>
 
 namespace jslite {
 
-const size_t MAX_STACK_DEPTH = 100000;
-
 static const char* jslite_strerror(int32_t err) {
 	static const struct {
 		int32_t err;
@@ -25,6 +28,8 @@ static const char* jslite_strerror(int32_t err) {
 		{ERR_OBJECT_SEP, "colon seperator is requried to object"},
 		{ERR_OBJECT_END, "End of object (\"}\") is required"},
 		{ERR_NUMBER, "Invalid number string"},
+		{ERR_CANCELED, "Canceled by the handler"},
+		{ERR_FILE, "Can not read the file"},
 		{0, NULL}
 	};
 
@@ -35,128 +40,32 @@ static const char* jslite_strerror(int32_t err) {
 	return "Unknown error";
 }
 
-int32_t ParseString(const JsonTokenzier::Token& token, std::string& str) {
-    str.clear();
-
-    const char *it = token.begin;
-
-    if ('"' != *it) return ERR_QUOTES;
-
-    str.reserve(token.end - token.begin + 2);
-    ++it;
-    for(; it != token.end && *it != '"'; ++it) {
-        if ('\\' == *it) {
-            switch(*++it) {
-            case '"': case '\\': case '/': str += *it; break;
-            case 'b': str += '\b'; break;
-            case 'f': str += '\f'; break;
-            case 'n': str += '\n'; break;
-            case 'r': str += '\r'; break;
-            case 't': str += '\t'; break;
-            case 'u': //u: 2chars(json only), U:4chars
-                ++it;
-                if (std::distance(it, token.end) < 4) return ERR_UNICODE;
-                if (!(isxdigit(*it) && isxdigit(*(it+1)) && isxdigit(*(it+2)) && isxdigit(*(it+3)))) return ERR_UNICODE;
-                str += UnicodeToUTF8(asc2hex(*it, *(it+1)), asc2hex(*(it+2), *(it+3)));
-                it += 3;
-                break;
-            default: return ERR_ESC_CHAR;
-            }
-        } else {
-            str += *it;
-        }
-    }
+////////////////////////////////////////////////////////////////////////////////////
+//public methods
 
-    if ('"' != *it) return ERR_QUOTES;
+// the parsers of a stream, kept with their stacks and buffers from one
+// parse to the next
+struct JsonStream::Parsers {
+    Parsers() : dom(builder), sax(builder) {}
 
-    return 0;
-}
+    JsonDomBuilder                  builder;
+    JsonSaxParser<JsonDomBuilder>   dom; // with builder
+    JsonSaxParser<JsonHandler>      sax; // with the handler of each parse
+};
 
-int32_t ParseString(Json &json, const JsonTokenzier::Token& token) {
-    std::string str;
+JsonStream::JsonStream()
+    : parsers_(NULL), indent_(0), key_order_(KEY_ORDER_SORTED), key_pool_(NULL),
+      parse_flags_(PARSE_DEFAULT), max_depth_(MAX_PARSE_DEPTH), projection_(NULL) { }
 
-    int32_t ret = ParseString(token, str);
-    if (0 != ret) return ret;
-    json = str;
-    return 0;
+JsonStream::~JsonStream() {
+    delete parsers_;
 }
 
-int32_t ParseDouble(Json &json, const JsonTokenzier::Token& token) {
-    ptrdiff_t len = token.end - token.begin;
-
-    jslite::Json::Real num = 0.0;
-    char *pt = NULL;
-
-    if (32 > len) {
-        char buf[32];
-        memcpy(buf, token.begin, len);
-        buf[len] = '\0';
-        num = strtod(buf, &pt);
-        if (pt != (buf + len)) return ERR_NUMBER;
-    } else {
-        char *buf = (char*)malloc(len+1);
-        memcpy(buf, token.begin, len);
-        buf[len] = '\0';
-        num = strtod(buf, &pt);
-        free(buf);
-        if (pt != (buf + len)) return ERR_NUMBER;
-    }
-
-    json = num;
-
-    return 0;
+JsonStream::Parsers& JsonStream::parsers() {
+    if (NULL == parsers_) parsers_ = new Parsers();
+    return *parsers_;
 }
 
-int32_t ParseInteger(Json &json, const JsonTokenzier::Token& token) {
-
-    if (token.begin == token.end) {
-        json = 0;
-        return 0;
-    }
-
-    ptrdiff_t len = token.end - token.begin;
-
-    char str[20] = {0,};
-    char *pt = NULL;
-
-    if (10 > len) {
-        memcpy(str, token.begin, len);
-        int32_t val = strtol(str, &pt, 10);
-        if (str+len != pt) return ERR_NUMBER;
-        json = val;
-        return 0;
-    }
-
-    if ('-' == *token.begin) {
-        --len;
-        if (19 > len) {
-            memcpy(str, token.begin, len);
-            jslite::Json::Integer val = strtoll(str, &pt, 10);
-            if (str+len != pt) return ERR_NUMBER;
-            json  = val;
-            return 0;
-        }
-    } else {
-        if (20 > len) {
-            memcpy(str, token.begin, len);
-            jslite::Json::UInteger val = strtoull(str, &pt, 10);
-            if (str+len != pt) return ERR_NUMBER;
-            json = val;
-            return 0;
-        }
-    }
-
-    return ParseDouble(json, token);
-}
-
-
-////////////////////////////////////////////////////////////////////////////////////
-//public methods
-
-JsonStream::JsonStream() : indent_(0), tokenizer_(NULL) { }
-
-JsonStream::~JsonStream() { }
-
 void JsonStream::FormattingBegin(const std::string& sep) {
     oss_ << sep;
     if (std::string::npos  != sep.find_first_of('\n')) {
@@ -196,17 +105,100 @@ void JsonStream::set_comma_sep(const std::string& sep) { comma_sep_ = sep; }
 
 void JsonStream::set_colon_sep(const std::string& sep) { colon_sep_ = sep; }
 
+void JsonStream::set_key_pool(JsonKeyPool* pool) { key_pool_ = pool; }
+
+void JsonStream::set_parse_flags(uint32_t flags) { parse_flags_ = flags; }
+
+void JsonStream::set_max_depth(size_t depth) { max_depth_ = depth; }
+
+void JsonStream::set_projection(const JsonProjection* projection) { projection_ = projection; }
+
+void JsonStream::set_key_order(KeyOrder order) { key_order_ = order; }
+
 int32_t JsonStream::Parse(Json& json) {
+    Tokenize();
+    return Parse(json, &key_pool());
+}
+
+int32_t JsonStream::Parse(JsonDocument& doc) {
+    doc.reset();
+    Tokenize();
+    return Parse(doc.root(), &doc.keys());
+}
+
+int32_t JsonStream::Parse(JsonHandler& handler) {
+    Tokenize();
+    return ParseEvents(handler);
+}
+
+int32_t JsonStream::Parse(const StringRef& text, Json& json) {
+    Tokenize(text.data, text.data + text.size);
+    return Parse(json, &key_pool());
+}
+
+int32_t JsonStream::Parse(const StringRef& text, JsonDocument& doc) {
+    doc.reset();
+    Tokenize(text.data, text.data + text.size);
+    return Parse(doc.root(), &doc.keys());
+}
+
+int32_t JsonStream::Parse(const StringRef& text, JsonHandler& handler) {
+    Tokenize(text.data, text.data + text.size);
+    return ParseEvents(handler);
+}
+
+// the tokenizer is ready for the text
+int32_t JsonStream::Parse(Json& json, JsonKeyPool* keys) {
+    Parsers &p = parsers();
+    p.builder.Reset(json, keys);
+    // the counts of the arrays skipped by a projection would be used for
+    // the ones that follow them
+    if ((parse_flags_ & PARSE_PRESIZE_ARRAYS) && NULL == projection_) {
+        tokenizer_.CountArrayElements(array_sizes_);
+        p.builder.set_array_sizes(&array_sizes_);
+    }
+
+    p.dom.set_parse_flags(parse_flags_);
+    p.dom.set_max_depth(max_depth_);
+    p.dom.set_projection(projection_);
+    return p.dom.Parse(tokenizer_);
+}
+
+int32_t JsonStream::ParseEvents(JsonHandler& handler) {
+    Parsers &p = parsers();
+    p.sax.set_handler(handler);
+    p.sax.set_parse_flags(parse_flags_);
+    p.sax.set_max_depth(max_depth_);
+    p.sax.set_projection(projection_);
+    return p.sax.Parse(tokenizer_);
+}
+
+JsonTokenzier& JsonStream::Tokenize() {
     str_ = oss_.str();
-    tokenizer_ = new JsonTokenzier(str_.c_str(), str_.c_str() + str_.size());
-    if (NULL == tokenizer_) return ERR_NO_MEMORY;
+    return Tokenize(str_.c_str(), str_.c_str() + str_.size());
+}
 
-    return ParseValue(json);
+JsonTokenzier& JsonStream::Tokenize(const char* begin, const char* end) {
+    tokenizer_.Reset(begin, end);
+    if ((parse_flags_ & PARSE_STRUCTURAL_INDEX) && index_.Build(begin, end)) {
+        tokenizer_.set_index(index_.data(), index_.size());
+    }
+    return tokenizer_;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
 //protected methods
 
+void JsonStream::Reset() {
+    str_.clear();
+    oss_.str(std::string());
+    oss_.clear();
+    indent_ = 0;
+    tokenizer_.Reset(str_.c_str(), str_.c_str());
+    index_.clear();
+    array_sizes_.clear();
+}
+
 std::string JsonStream::str() const {
 	return oss_.str();
 }
@@ -229,48 +221,60 @@ JsonStream& JsonStream::operator << (const std::string& s) {
 std::string JsonStream::strerror(int32_t err) {
 	std::ostringstream oss;
 	oss << jslite_strerror(err) << std::endl;
-	if (tokenizer_) oss << tokenizer_->str();
+	if (tokenizer_.CurrentToken().begin) oss << tokenizer_.str();
 	return  oss.str();
 }
 
 int32_t JsonStream::PrintValue(const Json& json) {
-    int32_t ret = 0;
-    if (json.IsNull()) {
-        oss_ << "null";
-    } else if (json.IsString()) {
-        ret = PrintString(json);
-    } else if (json.IsInteger()) {
-        oss_ << json.integer();
-    } else if (json.IsUInteger()) {
-        oss_ << json.uinteger();
-    } else if (json.IsReal()) {
-        oss_ << json.real();
-    } else if (json.IsObject()) {
-        ret = PrintObject(json);
-    } else if (json.IsArray()) {        
-        ret = PrintArray(json);
-    } else if (json.IsBoolean()) {        
-        oss_ << (json.boolean()?"true":"false");
-    } else {
+    // numbers kept as text are printed as they were parsed
+    StringRef raw = json.number_ref();
+    if (raw.data) {
+        oss_.write(raw.data, raw.size);
+        return 0;
+    }
+
+    switch(json.type()) {
+    case Json::TYPE_NULL:     oss_ << "null"; break;
+    case Json::TYPE_STRING:   return PrintString(json);
+    case Json::TYPE_INTEGER:  oss_ << json.integer(); break;
+    case Json::TYPE_UINTEGER: oss_ << json.uinteger(); break;
+    case Json::TYPE_REAL:     oss_ << json.real(); break;
+    case Json::TYPE_OBJECT:   return PrintObject(json);
+    case Json::TYPE_ARRAY:    return PrintArray(json);
+    case Json::TYPE_BOOLEAN:  oss_ << (json.boolean()?"true":"false"); break;
+    default:
         return ERR_JSON_TYPE;
     }
 
-    return ret;
+    return 0;
+}
+
+static bool KeyLess(const Json::Object::Member* l, const Json::Object::Member* r) {
+    return l->first < r->first;
 }
 
 int32_t JsonStream::PrintObject(const Json& json) {
-    Json::Object::iterator begin(json.object().begin());
-    Json::Object::iterator end(json.object().end());
+    const Json::Object &obj = json.object();
+
+    // members are kept in the order they were added
+    std::vector<const Json::Object::Member*> members;
+    if (KEY_ORDER_SORTED == key_order_) {
+        members.reserve(obj.size());
+        for (Json::Object::const_iterator it = obj.begin(); it != obj.end(); ++it) members.push_back(it);
+        std::sort(members.begin(), members.end(), KeyLess);
+    }
+
     oss_ << "{";
     FormattingBegin(obj_sep_);
     int32_t ret = 0;
-    for(Json::Object::iterator it(begin);it != end; ++it) {
-        if (it != begin) {
+    for(size_t i = 0; i < obj.size(); ++i) {
+        if (i != 0) {
             oss_ << ",";
             FormattingComma();
         }
-        oss_ << "\"" << it->first << "\":" << colon_sep_;
-        if (0 != (ret = PrintValue(it->second))) return ret;
+        const Json::Object::Member &member = (members.empty() ? *(obj.begin() + i) : *members[i]);
+        oss_ << "\"" << member.first << "\":" << colon_sep_;
+        if (0 != (ret = PrintValue(member.second))) return ret;
     }
     FormattingEnd(obj_sep_);
     oss_ << "}";
@@ -296,8 +300,9 @@ int32_t JsonStream::PrintArray(const Json& json) {
 }
 
 int32_t JsonStream::PrintString(const Json& json) {
-    Json::String::const_iterator it(json.string().begin());
-    Json::String::const_iterator end(json.string().end());
+    const StringRef ref = json.string_ref();
+    const char *it = ref.data;
+    const char *end = ref.data + ref.size;
 
     oss_ << "\"";
 
@@ -338,6 +343,16 @@ JsonStream& default_sep(JsonStream& printer) {
     return printer;
 }
 
+JsonStream& sorted_keys(JsonStream& jstm) {
+    jstm.set_key_order(KEY_ORDER_SORTED);
+    return jstm;
+}
+
+JsonStream& insertion_keys(JsonStream& jstm) {
+    jstm.set_key_order(KEY_ORDER_INSERTION);
+    return jstm;
+}
+
 #define DEF_OPT(name) \
 void name(JsonStream& jstm, const std::string& val) {\
     jstm.set_##name(val);\
@@ -351,101 +366,6 @@ DEF_OPT(array_sep)
 DEF_OPT(indent_sep)
 DEF_OPT(comma_sep)
 
-int32_t JsonStream::ParseValue(Json &json, size_t depth) {
-    if (depth > MAX_STACK_DEPTH) return ERR_OVERFLOW;
-
-    int32_t ret = 0;
-
-    const JsonTokenzier::Token token = tokenizer_->SkipCommentAndNextToken();
-
-    switch(token.type) {
-    case JsonTokenzier::TK_ARR_BEGIN:
-        ret = ParseArray(json, depth+1);
-        break;
-    case JsonTokenzier::TK_OBJ_BEGIN:
-        ret = ParseObject(json, depth+1);
-        break;
-    case JsonTokenzier::TK_STRING:
-        ret = jslite::ParseString(json, token);
-        break;
-    case JsonTokenzier::TK_INTEGER:
-        ret = jslite::ParseInteger(json, token);
-        break;
-    case JsonTokenzier::TK_REAL:
-        ret = jslite::ParseDouble(json, token);
-        break;
-    case JsonTokenzier::TK_TRUE:
-        json = true;
-        break;
-    case JsonTokenzier::TK_FALSE:
-        json = false;
-        break;
-    case JsonTokenzier::TK_NULL:
-        break;
-    default:
-        return ERR_VALUE;
-    }
-
-    return ret;
-}
-
-int32_t JsonStream::ParseArray(Json &json, size_t depth) {
-    if (depth > MAX_STACK_DEPTH) return ERR_OVERFLOW;
-
-    json.array();
-
-    tokenizer_->SkipSpace();
-
-    if (']' == tokenizer_->Current()) {
-        tokenizer_->SkipCommentAndNextToken();
-        return 0;
-    }
-
-    JsonTokenzier::Token token;
-
-    int32_t ret = 0;
-    do {
-        Json value;
-        json.put(value);
-        ret = ParseValue(json[json.size()-1], depth+1);
-        if (0 != ret) return ret;
-        token = tokenizer_->SkipCommentAndNextToken();
-    } while(JsonTokenzier::TK_COMMA == token.type);
-
-    if (JsonTokenzier::TK_ARR_END != tokenizer_->CurrentToken().type) return ERR_ARRAY_END;
-
-    return 0;
-}
-    
-int32_t JsonStream::ParseObject(Json &json, size_t depth) {
-    if (depth > MAX_STACK_DEPTH) return ERR_OVERFLOW;
-
-    json.object();
-
-    JsonTokenzier::Token token;
-    std::string key;
-    int32_t ret = 0;
-
-    while(JsonTokenzier::TK_OBJ_END != (token = tokenizer_->SkipCommentAndNextToken()).type) {
-        if (JsonTokenzier::TK_STRING != token.type) return ERR_OBJECT_KEY;
-        ret = jslite::ParseString(token, key);
-        if (0 != ret) return ret;
-
-        token = tokenizer_->SkipCommentAndNextToken();
-        if (JsonTokenzier::TK_COLON != token.type) return ERR_OBJECT_SEP;
-
-        ret = ParseValue(json[key], depth+1); 
-        if (0 != ret) return ret;
-
-        token = tokenizer_->SkipCommentAndNextToken();
-        if (JsonTokenzier::TK_COMMA != token.type) break;
-    }
-
-    if (JsonTokenzier::TK_OBJ_END != token.type) return ERR_OBJECT_END;
-
-    return 0;
-}
-
 JsonStream& operator << (JsonStream& jstm, const Json& json) {
     int32_t ret = jstm.Print(json);
     return jstm;
@@ -3,8 +3,11 @@
 
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include "jsonlite.hpp"
+#include "json_simd.hpp"
+#include "json_tokenizer.hpp"
 
 namespace jslite {
 
@@ -23,9 +26,29 @@ typedef enum {
 	ERR_OBJECT_SEP, // colon for seperation of oject is requried
 	ERR_OBJECT_END, // a end of object("}") is required
 	ERR_NUMBER, // wrong number string
+	ERR_CANCELED, // a handler stopped the parse
+	ERR_FILE, // a file can not be opened or mapped
 } ErrnoNo;
 
-class JsonTokenzier;
+typedef enum {
+	KEY_ORDER_SORTED = 0, // members of an object are printed in the order of keys
+	KEY_ORDER_INSERTION, // members are printed in the order they were added
+} KeyOrder;
+
+typedef enum {
+	PARSE_DEFAULT = 0,
+	PARSE_ZERO_COPY = 0x01, // strings refer to the parsed text instead of copying it
+	PARSE_PRESIZE_ARRAYS = 0x02, // count elements ahead and reserve arrays once
+	PARSE_LAZY_NUMBERS = 0x04, // numbers are converted on first access and printed as parsed
+	PARSE_STRUCTURAL_INDEX = 0x08, // tokens are located ahead with simd instructions
+} ParseFlags;
+
+// nesting of containers the parsers allow unless told otherwise
+const size_t MAX_PARSE_DEPTH = 100000;
+
+class JsonDocument;
+class JsonHandler;
+class JsonProjection;
 
 class JsonStream {
 public:
@@ -40,9 +63,42 @@ public:
     void set_indent_sep(const std::string& sep);
     void set_comma_sep(const std::string& sep);
     void set_colon_sep(const std::string& sep);
+    void set_key_order(KeyOrder order);
+
+    // keys of parsed objects are interned into pool, which can be shared by
+    // several streams. NULL uses the pool of this stream.
+    void set_key_pool(JsonKeyPool* pool);
+    JsonKeyPool& key_pool() { return key_pool_ ? *key_pool_ : keys_; }
+
+    // with PARSE_ZERO_COPY string values, and with PARSE_LAZY_NUMBERS
+    // numbers, point into the parsed text: the text of this stream, valid
+    // until the next Parse() or str(), or the text given to Parse().
+    // unescaping and conversion are put off until a value is read.
+    void set_parse_flags(uint32_t flags);
+    // containers deeper than depth are ERR_OVERFLOW
+    void set_max_depth(size_t depth);
+    // only the values of projection are parsed, NULL for all of them
+    void set_projection(const JsonProjection* projection);
 
     //out operating
     int32_t Parse(Json& json);
+    int32_t Parse(JsonDocument& doc); // values are allocated from doc
+    int32_t Parse(JsonHandler& handler); // events instead of a tree
+
+    // the text of the caller, which is tokenized where it is instead of
+    // being copied into the stream. strerror() reads it as well.
+    int32_t Parse(const StringRef& text, Json& json);
+    int32_t Parse(const StringRef& text, JsonDocument& doc);
+    int32_t Parse(const StringRef& text, JsonHandler& handler);
+    int32_t Parse(const char* data, size_t len, Json& json) { return Parse(StringRef(data, len), json); }
+    int32_t Parse(const char* data, size_t len, JsonDocument& doc) { return Parse(StringRef(data, len), doc); }
+    int32_t Parse(const char* data, size_t len, JsonHandler& handler) { return Parse(StringRef(data, len), handler); }
+
+    // starts over with no text, as a stream that was not used. the parsers
+    // with their stacks and buffers, and the key pool, are kept, so parsing
+    // values of about the same shape allocates nothing but the values, and
+    // nothing at all into a document that keeps its memory.
+    void Reset();
 
     //others
     std::string str() const;
@@ -65,13 +121,17 @@ protected:
     void FormattingEnd(const std::string& sep);
 
     //out operating
-    int32_t ParseValue(Json &json, size_t depth = 0);
-    int32_t ParseArray(Json &json, size_t depth);
-    int32_t ParseObject(Json &json, size_t depth);
-    void TrimSpace();
+    int32_t Parse(Json& json, JsonKeyPool* keys);
+    int32_t ParseEvents(JsonHandler& handler);
+    JsonTokenzier& Tokenize(); // the text of this stream
+    JsonTokenzier& Tokenize(const char* begin, const char* end);
 
 private:
-    JsonTokenzier *tokenizer_;
+    struct Parsers;
+    Parsers& parsers();
+
+    JsonTokenzier tokenizer_;
+    Parsers      *parsers_; // made by the first parse, for all of them
     
 	uint32_t    indent_;
     std::string obj_sep_;
@@ -79,8 +139,16 @@ private:
     std::string indent_sep_;
     std::string comma_sep_;
     std::string colon_sep_;
+    KeyOrder    key_order_;
 
     std::string str_;
+    JsonKeyPool  keys_;
+    JsonKeyPool *key_pool_;
+    uint32_t     parse_flags_;
+    size_t       max_depth_;
+    const JsonProjection *projection_;
+    std::vector<uint32_t> array_sizes_; // counted ahead with PARSE_PRESIZE_ARRAYS
+    JsonStructuralIndex index_; // built with PARSE_STRUCTURAL_INDEX
 	std::ostringstream oss_;
 };
 
@@ -95,6 +163,8 @@ JOpt array_sep(const std::string& val);
 JOpt indent_sep(const std::string& val);
 JOpt comma_sep(const std::string& val);
 JsonStream& default_sep(JsonStream& jstm);
+JsonStream& sorted_keys(JsonStream& jstm);
+JsonStream& insertion_keys(JsonStream& jstm);
 
 
 //////////////////////////////////////////////////////////////
@@ -1,6 +1,8 @@
 #include "json_tokenizer.hpp"
 #include "json_util.hpp"
+#include "json_simd.hpp"
 
+#include <algorithm>
 #include <sstream>
 
 namespace jslite {
@@ -30,7 +32,25 @@ static const char* type_name(JsonTokenzier::TokenType type) {
 }
 
 
-JsonTokenzier::JsonTokenzier(const char *begin, const char *end) : begin_(begin), end_(end), it_(begin) {}
+JsonTokenzier::JsonTokenzier()
+    : begin_(NULL), end_(NULL), it_(NULL), index_(NULL), index_size_(0), next_(0) {}
+
+JsonTokenzier::JsonTokenzier(const char *begin, const char *end)
+    : begin_(begin), end_(end), it_(begin), index_(NULL), index_size_(0), next_(0) {}
+
+void JsonTokenzier::Reset(const char *begin, const char *end) {
+    begin_ = it_ = begin;
+    end_ = end;
+    token_.clear();
+    index_ = NULL;
+    index_size_ = next_ = 0;
+}
+
+void JsonTokenzier::set_index(const uint32_t* positions, size_t count) {
+    index_ = positions;
+    index_size_ = count;
+    next_ = 0;
+}
 
 char JsonTokenzier::Current() {
 	return (IsDone() ? 0 : *it_);
@@ -48,7 +68,7 @@ bool JsonTokenzier::IsDone() {
 	return it_ == end_;
 }
 
-const JsonTokenzier::Token& JsonTokenzier::CurrentToken() {
+const JsonTokenzier::Token& JsonTokenzier::CurrentToken() const {
 	return token_;
 }
 
@@ -59,8 +79,33 @@ const JsonTokenzier::Token& JsonTokenzier::SkipCommentAndNextToken() {
     return token_;
 }
 
+// moves to the next indexed token. true if the token starts at a position
+// of the index, false when a number or a literal stopped in the middle of
+// a run of characters and the scalar tokenizer goes on from there.
+bool JsonTokenzier::SkipToIndexed() {
+    while (next_ < index_size_ && begin_ + index_[next_] < it_) ++next_;
+
+    if (next_ < index_size_ && begin_ + index_[next_] == it_) {
+        ++next_;
+        return true;
+    }
+    if (!IsDone() && SkipSpaces(it_, end_) == it_) return false; // not a space
+
+    if (next_ < index_size_) {
+        it_ = begin_ + index_[next_++];
+        return true;
+    }
+    it_ = end_;
+    return false;
+}
+
 const JsonTokenzier::Token& JsonTokenzier::NextToken() {
-    SkipSpace();
+    bool indexed = false;
+    if (index_) {
+        indexed = SkipToIndexed();
+    } else {
+        SkipSpace();
+    }
     token_.clear();
     token_.begin = it_;
 
@@ -82,24 +127,23 @@ const JsonTokenzier::Token& JsonTokenzier::NextToken() {
         token_.type = (Expact("ull", 3)?TK_NULL:TK_WRONG);
         break;
     case '"':
-        for (c = Bump(); c && '"' != c; c = Bump()) {
-            if ('\\' == c) Bump();
+        // the closing quote is the next position of the index
+        if (indexed && next_ < index_size_) {
+            it_ = begin_ + index_[next_++] + 1;
+            token_.type = TK_STRING;
+            break;
         }
+        // control characters are kept as they are
+        do {
+            it_ = ScanString(it_, end_);
+            if ('\\' == (c = Bump())) Bump();
+        } while (c && '"' != c);
         token_.type = ('"' == c ? TK_STRING : TK_WRONG);
         break;
     case '0': case '1': case '2': case '3': case '4': case '5': 
     case '6': case '7': case '8': case '9': case '-': case '+':
-        token_.type = TK_INTEGER;
-
-        for (c = Current(); c; c = Next()) {
-            if (isdigit(c)) continue;
-            if ('+' == c || '-' == c) continue;
-            if ('.' == c || 'e' == c || 'E' == c) {
-                token_.type = TK_REAL;
-                continue;
-            }
-            break;
-        }
+        it_ = ScanNumber(token_.begin, end_, token_.number);
+        token_.type = (token_.number.integral ? TK_INTEGER : TK_REAL);
         break;
     case '/':
         c = Bump();
@@ -129,8 +173,47 @@ const JsonTokenzier::Token& JsonTokenzier::NextToken() {
     return token_;
 }
 
+bool JsonTokenzier::SkipValue() {
+    switch(token_.type) {
+    case TK_STRING: case TK_INTEGER: case TK_REAL:
+    case TK_TRUE: case TK_FALSE: case TK_NULL:
+        return true;
+    case TK_OBJ_BEGIN: case TK_ARR_BEGIN:
+        break;
+    default:
+        return false;
+    }
+
+    const char *close = SkipContainer(it_, end_);
+    if (close) {
+        token_.clear();
+        token_.type = ('}' == close[-1] ? TK_OBJ_END : TK_ARR_END);
+        token_.begin = close - 1;
+        token_.end = it_ = close;
+        if (index_) next_ = std::lower_bound(index_ + next_, index_ + index_size_, (uint32_t)offset()) - index_;
+        return true;
+    }
+
+    // comments, or a text that ends inside the value, token by token
+    for (size_t depth = 1; depth > 0;) {
+        switch(SkipCommentAndNextToken().type) {
+        case TK_OBJ_BEGIN: case TK_ARR_BEGIN:
+            ++depth;
+            break;
+        case TK_OBJ_END: case TK_ARR_END:
+            --depth;
+            break;
+        case TK_EOF: case TK_WRONG:
+            return false;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
 void JsonTokenzier::SkipSpace() {
-    for (char c = Current(); !IsDone() && isspace(c); c = Next());
+    it_ = SkipSpaces(it_, end_);
 }
 
 std::string JsonTokenzier::str() {
@@ -147,7 +230,8 @@ std::string JsonTokenzier::str() {
 	std::string token;
 	size_t len = token_.end - token_.begin;
 	if (0 == len) {
-		token = *token_.begin;
+		// the text of the caller ends at end_, without a NUL after it
+		if (token_.begin < end_) token = *token_.begin;
 	} else if (32 > len) {
 		token.assign(token_.begin, len);
 	} else {
@@ -163,6 +247,62 @@ std::string JsonTokenzier::str() {
     return fstr.str();
 }
 
+void JsonTokenzier::CountArrayElements(std::vector<uint32_t>& counts) const {
+    struct Level {
+        size_t index; // into counts, NPOS for an object
+        bool   empty;
+    };
+    std::vector<Level> levels;
+
+    counts.clear();
+    for (const char *it = it_; it < end_; ++it) {
+        char c = *it;
+        switch(c) {
+        case ' ': case '\t': case '\r': case '\n': case ':':
+            continue;
+        case ',':
+            if (!levels.empty() && NPOS != levels.back().index) ++counts[levels.back().index];
+            continue;
+        case ']': case '}':
+            if (!levels.empty()) levels.pop_back();
+            continue;
+        case '/':
+            if (it + 1 < end_ && '/' == it[1]) {
+                while (it < end_ && '\n' != *it) ++it;
+                continue;
+            }
+            if (it + 1 < end_ && '*' == it[1]) {
+                for (it += 2; it + 1 < end_ && !('*' == it[0] && '/' == it[1]); ++it);
+                ++it;
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+
+        // the first character of a value
+        if (!levels.empty() && levels.back().empty) {
+            levels.back().empty = false;
+            if (NPOS != levels.back().index) counts[levels.back().index] = 1;
+        }
+
+        if ('"' == c) {
+            for (++it; (it = ScanString(it, end_)) < end_ && '"' != *it; ++it) {
+                if ('\\' == *it && ++it == end_) break;
+            }
+            if (it == end_) break; // the text ends in the string
+        } else if ('[' == c || '{' == c) {
+            Level level = { NPOS, true };
+            if ('[' == c) {
+                level.index = counts.size();
+                counts.push_back(0);
+            }
+            levels.push_back(level);
+        }
+    }
+}
+
 bool JsonTokenzier::Expact(const char *str, ptrdiff_t len) {
     if (end_ - it_ < len) return false;
     if (0 != strncmp(str, it_, len)) return false;
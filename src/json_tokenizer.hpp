@@ -2,6 +2,10 @@
 #define __JS_JSON_TOKENIZER_HPP_20130410__
 
 #include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "json_number.hpp"
 
 namespace jslite {
 
@@ -19,28 +23,54 @@ public:
         TokenType type;
         const char *begin;
         const char *end;
+        JsonNumber number; // parts of TK_INTEGER and TK_REAL
     };
 
+    JsonTokenzier();
     JsonTokenzier(const char *begin, const char *end);
 
+    // starts over with the text of [begin, end)
+    void Reset(const char *begin, const char *end);
+
 	char Current();
 	char Next();
     char Bump();
     bool IsDone();
-    const Token& CurrentToken();
+    const Token& CurrentToken() const;
     const Token& SkipCommentAndNextToken();
     const Token& NextToken();
     void SkipSpace();
     std::string str();
+    size_t offset() const { return it_ - begin_; } // from begin
+
+    // positions of the tokens ahead from JsonStructuralIndex, relative to
+    // begin. NextToken() jumps between them instead of reading every byte.
+    void set_index(const uint32_t* positions, size_t count);
+
+    // goes past the value that begins at the current token, which becomes
+    // the last token of the value. a container is jumped over by counting
+    // brackets outside of strings, without tokens for what is inside, so
+    // only brackets are matched. false when the text ends inside the value
+    // or the token does not begin one.
+    bool SkipValue();
+
+    // number of elements of each array ahead, in the order the arrays begin
+    void CountArrayElements(std::vector<uint32_t>& counts) const;
 
 protected:
 	bool Expact(const char *str, ptrdiff_t len);
+    bool SkipToIndexed();
 
 private:
     const char *begin_;
     const char *end_;
     const char *it_;
     Token token_;
+
+    const uint32_t *index_;
+    size_t          index_size_;
+    size_t          next_; // next position of index_
+
 };
 
 } // namespace jslite
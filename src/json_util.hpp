@@ -2,6 +2,7 @@
 #define __JSON_UTIL_HPP_20141105__
 
 #include <stdint.h>
+#include <string.h>
 #include <string>
 #include <sstream>
 
@@ -69,6 +70,12 @@ private:
 	int         idx_;
 };
 
+// true if a string keeps its characters out of the small buffer
+inline
+bool OwnsMemory(const std::string& str) {
+    return str.capacity() > std::string().capacity();
+}
+
 inline
 uint8_t asc2hex(uint8_t c) { return (c>'9') ? (toupper(c)+10-'A') : c-'0'; }
 
@@ -107,6 +114,35 @@ std::string UnicodeToUTF8(uint16_t h, uint16_t  l) {
 }
 
 
+// appends the characters of a json string between it and end to str.
+// escape sequences must have been validated.
+inline
+void Unescape(const char* it, const char* end, std::string& str) {
+    str.reserve(str.size() + (end - it));
+    while (it != end) {
+        const char *esc = static_cast<const char*>(memchr(it, '\\', end - it));
+        if (NULL == esc) esc = end;
+        str.append(it, esc);
+        if (esc == end) break;
+
+        it = esc + 1;
+        switch(*it) {
+        case 'b': str += '\b'; break;
+        case 'f': str += '\f'; break;
+        case 'n': str += '\n'; break;
+        case 'r': str += '\r'; break;
+        case 't': str += '\t'; break;
+        case 'u': //u: 2chars(json only), U:4chars
+            str += UnicodeToUTF8(asc2hex(*(it+1), *(it+2)), asc2hex(*(it+3), *(it+4)));
+            it += 4;
+            break;
+        default: str += *it; break; // '"', '\\', '/'
+        }
+        ++it;
+    }
+}
+
+
 inline
 std::wstring ToUCS2(const std::string& src) {
     std::wstring target;
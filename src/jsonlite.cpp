@@ -1,74 +1,260 @@
 #include "jsonlite.hpp"
 #include "json_util.hpp"
+#include "json_number.hpp"
+#include <string.h>
+#include <stdlib.h>
 #include <sstream>
+#include <new>
 
 namespace jslite {
 
-Json::Json() : value_(NULL) {}
+static const char* type_name(Json::ValueType type) {
+    switch(type) {
+    case Json::TYPE_NULL:     return "NULL";
+    case Json::TYPE_BOOLEAN:  return "BOOLEAN";
+    case Json::TYPE_INTEGER:  return "INTEGER";
+    case Json::TYPE_UINTEGER: return "UINTEGER";
+    case Json::TYPE_REAL:     return "REAL";
+    case Json::TYPE_STRING:   return "STRING";
+    case Json::TYPE_ARRAY:    return "ARRAY";
+    case Json::TYPE_OBJECT:   return "OBJECT";
+    }
+
+    return "Unknown";
+}
 
-Json::Json(const char* val) : value_(new Any<String>(val)) {}
+Json::Json() : type_(TYPE_NULL), flags_(0) {}
 
-Json::Json(const String& val) : value_(new Any<String>(val)) {}
+Json::Json(const char* val) : type_(TYPE_STRING), flags_(0) { new (value_.s_) String(val); }
 
-Json::Json(Boolean val) : value_(new Any<Boolean>(val)) {}
+Json::Json(const String& val) : type_(TYPE_STRING), flags_(0) { new (value_.s_) String(val); }
 
-Json::Json(UInteger val) : value_(new Any<UInteger>(val)) {}
+Json::Json(String&& val) : type_(TYPE_STRING), flags_(0) { new (value_.s_) String(std::move(val)); }
 
-Json::Json(Real val) : value_(new Any<Real>(val)) {}
+Json::Json(const Array& val) : type_(TYPE_ARRAY), flags_(0) { value_.x_.a_ = NewArray(&val); }
 
-Json::Json(Integer val) : value_(new Any<Integer>(val)) {}
+Json::Json(Array&& val) : type_(TYPE_ARRAY), flags_(0) {
+    value_.x_.a_ = NewShared<Array>(std::move(val), Array::allocator_type());
+}
+
+Json::Json(const Object& val) : type_(TYPE_OBJECT), flags_(0) { value_.x_.o_ = NewObject(&val); }
+
+Json::Json(Object&& val) : type_(TYPE_OBJECT), flags_(0) {
+    value_.x_.o_ = NewShared<Object>(std::move(val), Object::allocator_type());
+}
 
-Json::Json(const Json& val) : value_(val.value_?val.value_->clone():NULL) { }
+Json::Json(Boolean val) : type_(TYPE_BOOLEAN), flags_(0) { value_.x_.b_ = val; }
+
+Json::Json(UInteger val) : type_(TYPE_UINTEGER), flags_(0) { value_.x_.u_ = val; }
+
+Json::Json(Real val) : type_(TYPE_REAL), flags_(0) { value_.x_.r_ = val; }
+
+Json::Json(Integer val) : type_(TYPE_INTEGER), flags_(0) { value_.x_.i_ = val; }
+
+Json::Json(const Json& val) : type_(TYPE_NULL), flags_(0) { Assign(val); }
+
+Json::Json(Json&& val) noexcept : type_(TYPE_NULL), flags_(0) {
+    Adopt(val.arena()); // the same arena, so nothing is copied
+    MoveFrom(val);
+}
 
 Json::~Json() { clear(); }
 
-Json& Json::Swap(Json& other) { std::swap(value_, other.value_); return *this; }
+void Json::Adopt(Arena* arena) {
+    if (NULL == arena) return;
+    flags_ |= F_ARENA;
+    value_.x_.arena_ = arena;
+}
+
+// copies other into this. this must be null.
+void Json::Assign(const Json& other) {
+    // containers on the heap are shared, others are copied
+    if ((TYPE_ARRAY == other.type_ || TYPE_OBJECT == other.type_) && !((flags_ | other.flags_) & F_ARENA)) {
+        other.materialize();
+        value_.x_ = other.value_.x_;
+        value_.x_.sh_->refs.fetch_add(1, std::memory_order_relaxed);
+        type_ = other.type_;
+        return;
+    }
+
+    other.Convert();
+
+    switch(other.type_) {
+    case TYPE_STRING: {
+        // a materialized view is copied without the characters it refers to
+        const Slot &x = other.value_.x_;
+        StringRef ref = ((other.flags_ & F_VIEW) && x.ps_) ? StringRef(*x.ps_) : other.string_ref();
+        SetString(ref.data, ref.size);
+        break;
+    }
+    case TYPE_ARRAY:    value_.x_.a_ = NewArray(other.value_.x_.a_); break;
+    case TYPE_OBJECT:   value_.x_.o_ = NewObject(other.value_.x_.o_); break;
+    case TYPE_BOOLEAN:  value_.x_.b_ = other.value_.x_.b_; break;
+    case TYPE_INTEGER:  value_.x_.i_ = other.value_.x_.i_; break;
+    case TYPE_UINTEGER: value_.x_.u_ = other.value_.x_.u_; break;
+    case TYPE_REAL:     value_.x_.r_ = other.value_.x_.r_; break;
+    default: break;
+    }
+    type_ = other.type_;
+}
+
+// takes over the payload of other and leaves other null. this must be null.
+// a payload can not move between arenas, so then it is copied.
+void Json::MoveFrom(Json& other) {
+    Arena *arena = this->arena();
+    if (arena != other.arena()) {
+        Assign(other);
+        other.clear();
+        return;
+    }
+
+    if (TYPE_STRING == other.type_ && NULL == arena && !(other.flags_ & F_VIEW)) {
+        new (value_.s_) String(std::move(other.str_value()));
+        other.str_value().~String();
+    } else {
+        value_.x_ = other.value_.x_;
+    }
+    flags_ |= other.flags_ & F_VALUE;
+    other.flags_ &= ~F_VALUE;
+    type_ = other.type_;
+    other.type_ = TYPE_NULL;
+}
+
+void Json::SetString(const char* data, size_t len) {
+    if (flags_ & F_VIEW) clear();
 
-bool Json::IsNull() const { return NULL == value_; }
+    Arena *arena = this->arena();
+    if (NULL == arena) {
+        if (TYPE_STRING == type_) {
+            str_value().assign(data, len);
+        } else {
+            new (value_.s_) String(data, len);
+        }
+    } else {
+        char *p = static_cast<char*>(arena->Allocate(len + 1, 1));
+        memcpy(p, data, len);
+        p[len] = '\0';
+        value_.x_.ps_ = NULL;
+        value_.x_.p_ = p;
+        value_.x_.n_ = len;
+    }
+    type_ = TYPE_STRING;
+}
 
-bool Json::IsString() const { return value_ && (typeid(String) == value_->type()); }
+Json::Array* Json::NewArray(const Array* other) {
+    Arena *arena = this->arena();
+    Array::allocator_type alloc((ArenaAllocator<Json>(arena)));
+    if (NULL == arena) return other ? NewShared<Array>(*other, alloc) : NewShared<Array>(alloc);
+    return other ? arena->New<Array>(*other, alloc) : arena->New<Array>(alloc);
+}
 
-bool Json::IsObject() const { return value_ && (typeid(Object) == value_->type()); }
+Json::Object* Json::NewObject(const Object* other) {
+    Arena *arena = this->arena();
+    Object::allocator_type alloc(arena);
+    if (NULL == arena) return other ? NewShared<Object>(*other, alloc) : NewShared<Object>(alloc);
+    return other ? arena->New<Object>(*other, alloc) : arena->New<Object>(alloc);
+}
 
-bool Json::IsArray() const  { return value_ && (typeid(Array) == value_->type()); }
+// gives this value its own copy of a shared container. the elements of the
+// copy share their containers in turn.
+void Json::Detach() {
+    if (flags_ & F_ARENA) return;
+    Shared *shared = value_.x_.sh_;
+    if (1 == shared->refs.load(std::memory_order_acquire)) {
+        shared->materialized = false; // the caller is about to write
+        return;
+    }
+
+    if (TYPE_ARRAY == type_) {
+        value_.x_.a_ = NewShared<Array>(*value_.x_.a_, Array::allocator_type());
+    } else {
+        value_.x_.o_ = NewShared<Object>(*value_.x_.o_, Object::allocator_type());
+    }
+    Release(shared);
+}
 
-bool Json::IsBoolean() const { return value_ && (typeid(Boolean) == value_->type()); }
+void Json::Release(Shared* shared) {
+    if (1 != shared->refs.fetch_sub(1, std::memory_order_acq_rel)) return;
+    if (TYPE_ARRAY == type_) {
+        delete static_cast<SharedBox<Array>*>(shared);
+    } else {
+        delete static_cast<SharedBox<Object>*>(shared);
+    }
+}
 
-bool Json::IsInteger() const { return value_ && (typeid(Integer) == value_->type()); }
+Json& Json::Swap(Json& other) {
+    if (this == &other) return *this;
 
-bool Json::IsUInteger() const { return value_ && (typeid(UInteger) == value_->type()); }
+    Json tmp(std::move(other));
+    other.MoveFrom(*this);
+    MoveFrom(tmp);
 
-bool Json::IsReal() const { return value_ && (typeid(Real) == value_->type()); }
+    return *this;
+}
 
-bool Json::IsNumber() const {
-    if (IsInteger() || IsUInteger() || IsReal()) return true;
-    return false;
+void Json::TypeMismatch(ValueType expected) const {
+    if (TYPE_NULL == type_) throw std::logic_error("null object");
+    std::ostringstream oss;
+    oss << "type mismatch: expected " << type_name(expected) << ", but " << type_name(type());
+    throw std::logic_error(oss.str());
 }
 
 void Json::remove() { clear(); }
 
 void Json::clear() {
-    if (value_) {
-        Dummy *dummy = value_;
-        value_ = NULL;
-        delete dummy;
+    // payloads in an arena are released together with the arena
+    if (flags_ & F_VIEW) {
+        if (!(flags_ & F_ARENA)) delete value_.x_.ps_;
+    } else if (!(flags_ & F_ARENA)) {
+        switch(type_) {
+        case TYPE_STRING: str_value().~String(); break;
+        case TYPE_ARRAY:
+        case TYPE_OBJECT: Release(value_.x_.sh_); break;
+        default: break;
+        }
     }
+    flags_ &= ~F_VALUE;
+    type_ = TYPE_NULL;
 }
 
 void Json::remove_at(size_t idx) {
     if (!IsArray()) return;
-    Array &arr = any_cast<Array>()->v_;
-    if (idx > arr.size()) return;
+    Array &arr = array();
+    if (idx >= arr.size()) return;
     arr.erase(arr.begin()+idx);
 }
 
 void Json::remove_by(const String& key) {
     if (!IsObject()) return;
-    Object &obj = any_cast<Object>()->v_;
-    obj.erase(key);
+    object().erase(key);
 }
 
-const Json::String& Json::string() const { return any_cast<Json::String>()->v_; }
+const Json::String& Json::string() const {
+    Expect(TYPE_STRING);
+    Arena *arena = this->arena();
+    if (NULL == arena && !(flags_ & F_VIEW)) return str_value();
+
+    // arena strings and views are kept as characters, build a String on demand
+    Slot &x = value_.x_;
+    if (NULL == x.ps_) {
+        String *str = arena ? arena->New<String>() : new String();
+        if (flags_ & F_ESCAPED) {
+            Unescape(x.p_, x.p_ + x.n_, *str);
+        } else {
+            str->assign(x.p_, x.n_);
+        }
+        if (arena && OwnsMemory(*str)) arena->Own(str);
+        x.ps_ = str;
+    }
+    return *x.ps_;
+}
+
+StringRef Json::string_ref() const {
+    Expect(TYPE_STRING);
+    if (flags_ & F_ESCAPED) return StringRef(string());
+    if (flags_ & (F_ARENA | F_VIEW)) return StringRef(value_.x_.p_, value_.x_.n_);
+    return StringRef(str_value());
+}
 
 Json::WString Json::wstring() const { return ToUCS2(string()); }
 
@@ -78,40 +264,90 @@ Json::String Json::multibyte() const { return UnicodeToMultibyte(wstring()); }
 //Json& Json::from_multibyte(const Json::String& str) { return operator = (MSConvertTo<WString>(str)); }
 #endif
 
-Json::Boolean Json::boolean() const { return any_cast<Boolean>()->v_; } 
+Json::Boolean Json::boolean() const {
+    Expect(TYPE_BOOLEAN);
+    return value_.x_.b_;
+}
 
-Json::Array& Json::array() const { return any_cast<Array>()->v_; }
+const Json::Array& Json::array() const {
+    Expect(TYPE_ARRAY);
+    return *value_.x_.a_;
+}
 
 Json::Array& Json::array() {
-    if (IsNull()) value_ = new Any<Array>();
-    return any_cast<Array>()->v_;
+    if (IsNull()) {
+        value_.x_.a_ = NewArray();
+        type_ = TYPE_ARRAY;
+    }
+    Expect(TYPE_ARRAY);
+    Detach();
+    return *value_.x_.a_;
 }
 
-Json::Object& Json::object() const { return any_cast<Object>()->v_; }
+const Json::Object& Json::object() const {
+    Expect(TYPE_OBJECT);
+    return *value_.x_.o_;
+}
 
 Json::Object& Json::object() {
-    if (IsNull()) value_ = new Any<Object>();
-    return any_cast<Object>()->v_;
+    if (IsNull()) {
+        value_.x_.o_ = NewObject();
+        type_ = TYPE_OBJECT;
+    }
+    Expect(TYPE_OBJECT);
+    Detach();
+    return *value_.x_.o_;
 }
 
-Json::Integer Json::integer() const { return any_cast<Integer>()->v_; }
+Json::Integer Json::integer() const {
+    Expect(TYPE_INTEGER);
+    return value_.x_.i_;
+}
 
-Json::UInteger Json::uinteger() const { return any_cast<UInteger>()->v_; }
+Json::UInteger Json::uinteger() const {
+    Expect(TYPE_UINTEGER);
+    return value_.x_.u_;
+}
 
-Json::Real Json::real() const { return any_cast<Real>()->v_; }
+Json::Real Json::real() const {
+    Expect(TYPE_REAL);
+    return value_.x_.r_;
+}
 
 Json& Json::operator = (const Json& val) {
-    Json(val).Swap(*this);
+    if (this != &val) {
+        Json tmp(std::allocator_arg, get_allocator(), val);
+        clear();
+        MoveFrom(tmp);
+    }
+    return *this;
+}
+
+Json& Json::operator = (Json&& val) {
+    if (this != &val) {
+        Json tmp(std::move(val)); // val may be inside this
+        clear();
+        MoveFrom(tmp);
+    }
     return *this;
 }
 
 Json& Json::operator = (const String& val) {
     //if (!unicodelite::ValidUTF8(val)) return *this; //TODO exception
+    return assign(val.data(), val.size());
+}
+
+Json& Json::operator = (String&& val) {
+    if (!IsNull()) Expect(TYPE_STRING);
+    if (flags_ & F_VIEW) clear();
+
+    if (flags_ & F_ARENA) return assign(val.data(), val.size());
 
     if (IsNull()) {
-        Json(val).Swap(*this);
+        new (value_.s_) String(std::move(val));
+        type_ = TYPE_STRING;
     } else {
-        any_cast<String>()->v_ = val;
+        str_value() = std::move(val);
     }
     return *this;
 }
@@ -123,44 +359,136 @@ Json& Json::operator = (const WString& val) {
         target += UnicodeToUTF8(val[i]);
     }
 
-    return operator = (target);
+    return operator = (std::move(target));
+}
+
+Json& Json::operator = (const char* val) { return assign(val, strlen(val)); }
+
+Json& Json::assign(const char* data, size_t len) {
+    if (!IsNull()) Expect(TYPE_STRING);
+    SetString(data, len);
+    return *this;
 }
 
-Json& Json::operator = (const char* val) { return operator = (String(val)); }
+Json& Json::assign_view(const char* data, size_t len, bool escaped) {
+    if (!IsNull()) Expect(TYPE_STRING);
+    clear();
+
+    value_.x_.ps_ = NULL;
+    value_.x_.p_ = data;
+    value_.x_.n_ = len;
+    flags_ |= F_VIEW | (escaped ? F_ESCAPED : 0);
+    type_ = TYPE_STRING;
+    return *this;
+}
+
+// the type follows the parser: a fraction or an exponent makes a real,
+// short integers are signed and long positive ones unsigned. integers too
+// long for 64 bits become reals.
+Json& Json::assign_number(const char* data, size_t len) {
+    JsonNumber number;
+    uint64_t value = 0;
+    ScanNumber(data, data + len, number);
+
+    ValueType type = TYPE_REAL;
+    switch(ClassifyNumber(number, data + len, value)) {
+    case NUMBER_INTEGER:  type = TYPE_INTEGER; break;
+    case NUMBER_UINTEGER: type = TYPE_UINTEGER; break;
+    default: break;
+    }
+
+    if (!IsNull()) Expect(type);
+    clear();
+
+    // integers come with the scan, only reals are left for later
+    value_.x_.u_ = value;
+    value_.x_.p_ = data;
+    value_.x_.n_ = len;
+    flags_ |= (TYPE_REAL == type ? F_RAW : F_RAW | F_CONVERTED);
+    type_ = type;
+    return *this;
+}
+
+StringRef Json::number_ref() const {
+    if (!(flags_ & F_RAW)) return StringRef();
+    return StringRef(value_.x_.p_, value_.x_.n_);
+}
+
+void Json::materialize() const {
+    switch(type_) {
+    case TYPE_REAL:
+        Convert();
+        break;
+    case TYPE_STRING:
+        if (flags_ & (F_ARENA | F_VIEW)) string();
+        break;
+    case TYPE_ARRAY:
+    case TYPE_OBJECT: {
+        // a shared container was materialized before it was shared
+        Shared *shared = (flags_ & F_ARENA) ? NULL : value_.x_.sh_;
+        if (shared && shared->materialized) return;
+        if (TYPE_ARRAY == type_) {
+            const Array &arr = *value_.x_.a_;
+            for (size_t i = 0; i < arr.size(); ++i) arr[i].materialize();
+        } else {
+            const Object &obj = *value_.x_.o_;
+            for (Object::const_iterator it = obj.begin(); it != obj.end(); ++it) it->second.materialize();
+        }
+        if (shared) shared->materialized = true;
+        break;
+    }
+    default: break;
+    }
+}
+
+void Json::ConvertText() const {
+    Slot &x = value_.x_;
+    JsonNumber number;
+    ScanNumber(x.p_, x.p_ + x.n_, number);
+    x.r_ = NumberToDouble(number, x.p_, x.p_ + x.n_);
+    flags_ |= F_CONVERTED;
+}
 
 Json& Json::operator = (Json::Boolean val) {
     if (IsNull()) {
-        Json(val).Swap(*this);
+        type_ = TYPE_BOOLEAN;
     } else {
-        any_cast<Boolean>()->v_ = val;
+        Expect(TYPE_BOOLEAN);
     }
+    value_.x_.b_ = val;
     return *this;
 }
 
 Json& Json::operator = (Integer val) {
     if (IsNull()) {
-        Json(val).Swap(*this);
+        type_ = TYPE_INTEGER;
     } else {
-        any_cast<Integer>()->v_ = val;
+        Expect(TYPE_INTEGER);
     }
+    flags_ &= ~(F_RAW | F_CONVERTED);
+    value_.x_.i_ = val;
     return *this;
 }
 
 Json& Json::operator = (UInteger val) {
     if (IsNull()) {
-        Json(val).Swap(*this);
+        type_ = TYPE_UINTEGER;
     } else {
-        any_cast<UInteger>()->v_ = val;
+        Expect(TYPE_UINTEGER);
     }
+    flags_ &= ~(F_RAW | F_CONVERTED);
+    value_.x_.u_ = val;
     return *this;
 }
 
 Json& Json::operator = (Real val) {
     if (IsNull()) {
-        Json(val).Swap(*this);
+        type_ = TYPE_REAL;
     } else {
-        any_cast<Real>()->v_ = val;
+        Expect(TYPE_REAL);
     }
+    flags_ &= ~(F_RAW | F_CONVERTED);
+    value_.x_.r_ = val;
     return *this;
 }
 
@@ -170,66 +498,91 @@ Json& Json::operator = (int val) {
 
 bool Json::operator == (const Json& other) const {
     if (this == &other) return true;
-    if (IsNull()) return other.IsNull();
-    if (other.IsNull()) return false;
-    if (value_->type() != other.value_->type()) return false;
-    if (IsInteger()) return integer() == other.integer();
-    if (IsUInteger()) return uinteger() == other.uinteger();
-    if (IsReal()) return real() == other.real();
-    if (IsString()) return string() == other.string();
-    if (IsArray())  return array() == other.array();
-    if (IsObject()) return object() == other.object();
+    if (type_ != other.type_) return false;
+    Convert();
+    other.Convert();
+    switch(type_) {
+    case TYPE_NULL:     return true;
+    case TYPE_BOOLEAN:  return value_.x_.b_ == other.value_.x_.b_;
+    case TYPE_INTEGER:  return value_.x_.i_ == other.value_.x_.i_;
+    case TYPE_UINTEGER: return value_.x_.u_ == other.value_.x_.u_;
+    case TYPE_REAL:     return value_.x_.r_ == other.value_.x_.r_;
+    case TYPE_STRING: {
+        StringRef l = string_ref(), r = other.string_ref();
+        return l.size == r.size && 0 == memcmp(l.data, r.data, l.size);
+    }
+    case TYPE_ARRAY:    return value_.x_.a_ == other.value_.x_.a_ || *value_.x_.a_ == *other.value_.x_.a_;
+    case TYPE_OBJECT:   return value_.x_.o_ == other.value_.x_.o_ || *value_.x_.o_ == *other.value_.x_.o_;
+    }
     return false;
 }
 
 Json& Json::operator [] (const std::string& key) {
-    if (IsNull()) value_ = new Any<Object>();
-    return object()[key];
+    return emplace(key);
 }
 
-Json& Json::operator [] (const std::string& key) const {
-    return object()[key];
+const Json& Json::operator [] (const std::string& key) const {
+    static const Json null;
+    const Object &obj = object();
+    Object::const_iterator it = obj.find(key);
+    return it != obj.end() ? it->second : null;
 }
 
-Json& Json::operator [] (unsigned short idx) {
+Json& Json::operator [] (size_t idx) {
     Array &arr = array();
     if (idx >= arr.size()) throw std::range_error("out of range array");
     return arr[idx];
 }
 
-Json& Json::operator [] (unsigned short idx) const {
-    Array &arr = array();
+const Json& Json::operator [] (size_t idx) const {
+    const Array &arr = array();
     if (idx >= arr.size()) throw std::range_error("out of range array");
     return arr[idx];
 }
 
 Json& Json::put(const Json& val) {
-    if (IsNull()) value_ = new Any<Array>();
     array().push_back(val);
     return *this;
 }
 
+Json& Json::put(Json&& val) {
+    array().push_back(std::move(val));
+    return *this;
+}
+
 size_t Json::size() const {
-    if (IsNull()) return 0;
-    if (IsObject()) return object().size();
-    if (IsArray()) return array().size();
-    if (IsString()) return string().size();
-    return 1;
+    switch(type_) {
+    case TYPE_NULL:   return 0;
+    case TYPE_OBJECT: return value_.x_.o_->size();
+    case TYPE_ARRAY:  return value_.x_.a_->size();
+    case TYPE_STRING: return string_ref().size;
+    default:          return 1;
+    }
 }
 
 size_t Json::length() const { return size(); } //similar to javascript
+
+void Json::reserve(size_t n) {
+    if (IsObject()) {
+        object().reserve(n);
+    } else {
+        array().reserve(n);
+    }
+}
+
+size_t Json::capacity() const {
+    switch(type_) {
+    case TYPE_OBJECT: return value_.x_.o_->capacity();
+    case TYPE_ARRAY:  return value_.x_.a_->capacity();
+    default:          return 0;
+    }
+}
     
 //for debuging
 std::string Json::str() const {
     std::ostringstream oss;
-    oss << "{ \"value\":\"" << value_ << "\"";
-    oss << ", \"typeid\":\"";
-    if (value_) {
-        oss << value_->type().name();
-    }  else {
-        oss << typeid(value_).name();
-    }
-    oss << "\" }";
+    oss << "{ \"value\":\"" << this << "\"";
+    oss << ", \"type\":\"" << type_name(type()) << "\" }";
     return oss.str();
 }
 
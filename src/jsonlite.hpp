@@ -25,21 +25,44 @@
 #define __JSON_LITE_HPP_20121127__
 
 #include <stdint.h>
+#include <string.h>
+#include <string>
 #include <ostream>
-#include <typeinfo>
 #include <algorithm>
+#include <utility>
 #include <stdexcept>
 #include <functional>
-#include <map>
-#include <deque>
-#ifdef WIN32
+#include <vector>
+#include <atomic>
 #include <memory>
-#else
+#include <scoped_allocator>
+#ifndef WIN32
 #include <tr1/memory>
 #endif
 
+#include "json_arena.hpp"
+
 namespace jslite {
 
+// characters of a string without owning them
+struct StringRef {
+    StringRef() : data(NULL), size(0) {}
+    StringRef(const char* d, size_t n) : data(d), size(n) {}
+    StringRef(const std::string& s) : data(s.data()), size(s.size()) {}
+    StringRef(const char* s) : data(s), size(strlen(s)) {}
+
+    std::string str() const { return std::string(data, size); }
+
+    bool operator == (const StringRef& o) const { return size == o.size && 0 == memcmp(data, o.data, size); }
+    bool operator != (const StringRef& o) const { return !(*this == o); }
+
+    const char *data;
+    size_t      size;
+};
+
+class JsonDocument;
+class JsonObject;
+
 class Json {
 public:
     typedef Json                        Value;
@@ -49,38 +72,69 @@ public:
     typedef uint64_t                    UInteger;
     typedef double                      Real;
     typedef bool                        Boolean;
-    typedef std::map<std::string, Json> Object;
-    typedef std::deque<Json>            Array;
+
+    // containers pass their allocator down to the elements, so all values
+    // of a tree in a JsonDocument are allocated from the same arena.
+    typedef ArenaAllocator<Json>        allocator_type;
+    typedef JsonObject                  Object;
+    typedef std::vector<Json, std::scoped_allocator_adaptor<ArenaAllocator<Json> > > Array;
+
+    typedef enum {
+        TYPE_NULL, TYPE_BOOLEAN, TYPE_INTEGER, TYPE_UINTEGER, TYPE_REAL,
+        TYPE_STRING, TYPE_ARRAY, TYPE_OBJECT
+    } ValueType;
 
     Json();
     Json(const Json& val);
+    // takes over the payload together with its arena, so a value moved out
+    // of a document still lives in the arena of the document
+    Json(Json&& val) noexcept;
     Json(const char* val);
     Json(const String& val);
+    Json(String&& val);
+    Json(const Array& val);
+    Json(Array&& val);
+    Json(const Object& val);
+    Json(Object&& val);
     Json(Boolean val);
     Json(UInteger val);
     Json(Real val);
     Json(Integer val);
 
+    // allocator-extended constructor used by Object and Array
+    template <class... Args>
+    Json(std::allocator_arg_t, const allocator_type& alloc, Args&&... args) : type_(TYPE_NULL), flags_(0) {
+        Adopt(alloc.arena());
+        Init(std::forward<Args>(args)...);
+    }
+
     ~Json();
 
+    allocator_type get_allocator() const { return allocator_type(arena()); }
+
     Json& Swap(Json& other);
 
-    bool IsNull() const;
-    bool IsString() const;
-    bool IsObject() const;
-    bool IsArray() const;
-    bool IsBoolean() const;
-    bool IsInteger() const;
-    bool IsUInteger() const;
-    bool IsReal() const;
-    bool IsNumber() const;
+    ValueType type() const { return static_cast<ValueType>(type_); }
+
+    bool IsNull() const { return TYPE_NULL == type_; }
+    bool IsString() const { return TYPE_STRING == type_; }
+    bool IsObject() const { return TYPE_OBJECT == type_; }
+    bool IsArray() const { return TYPE_ARRAY == type_; }
+    bool IsBoolean() const { return TYPE_BOOLEAN == type_; }
+    bool IsInteger() const { return TYPE_INTEGER == type_; }
+    bool IsUInteger() const { return TYPE_UINTEGER == type_; }
+    bool IsReal() const { return TYPE_REAL == type_; }
+    bool IsNumber() const { return TYPE_INTEGER <= type_ && TYPE_REAL >= type_; }
 
     void remove();
     void clear();
     void remove_at(size_t idx);
     void remove_by(const String& key);
 
+    // a view or a string in an arena is built into a String on first use,
+    // so this const read writes the value. see materialize().
     const String& string() const;
+    StringRef string_ref() const;
     WString wstring() const;
 
 #ifdef WIN32
@@ -88,17 +142,23 @@ public:
     //Json& from_multibyte(const String& str);
 #endif
 
+    // non-const access to a container shared by copies clones it first
     Boolean boolean() const; 
-    Array& array() const;
+    const Array& array() const;
     Array& array();
-    Object& object() const;
+    const Object& object() const;
     Object& object();
     Integer integer() const;
     UInteger uinteger() const;
+    // a real kept as text is converted on first use, by real() or ==, and
+    // the result is kept, so these const reads write. see materialize().
     Real real() const;
 
     Json& operator = (const Json& val);
+    // a value keeps its arena, so a payload of another arena is copied
+    Json& operator = (Json&& val);
     Json& operator = (const String& val);
+    Json& operator = (String&& val);
     Json& operator = (const WString& val);
     Json& operator = (const char* val);
     Json& operator = (Boolean val);
@@ -106,26 +166,50 @@ public:
     Json& operator = (UInteger val);
     Json& operator = (Real val);
     Json& operator = (int val);
+    Json& assign(const char* data, size_t len);
+    // refers to the characters without copying them, they must outlive the
+    // value. escaped characters are json string contents still to unescape.
+    Json& assign_view(const char* data, size_t len, bool escaped = false);
+    // keeps the text of a valid json number, which must outlive the value,
+    // and converts it on first access.
+    Json& assign_number(const char* data, size_t len);
+    // text of a number as it was assigned, empty once the value is changed
+    StringRef number_ref() const;
+    // builds what const reads would build on first use, in this value and
+    // all values in it. copies do it before they share a container. call it
+    // before a value that is not copied is read by several threads.
+    void materialize() const;
 
     bool operator == (const Json& other) const;
     Json& operator [] (const std::string& key);
-    Json& operator [] (const std::string& key) const;
-    Json& operator [] (unsigned short idx);
-    Json& operator [] (unsigned short idx) const;
+    const Json& operator [] (const std::string& key) const; // null if no key
+    Json& operator [] (size_t idx);
+    const Json& operator [] (size_t idx) const;
     Json& put(const Json& val);
+    Json& put(Json&& val);
     size_t size() const;
     size_t length() const; //similar to javascript
+    void reserve(size_t n); // room for n elements, or members of an object
+    size_t capacity() const;
     
-    template <class Function>
-    Function for_keys(Function f) const {
-        const Object &obj = object();
-        for(Object::const_iterator it=obj.begin(); it!=obj.end(); ++it) f(it->first, it->second);
-        return f;
+    // constructs a new element at the end of array in place
+    template <class... Args>
+    Json& emplace_back(Args&&... args) {
+        Array &arr = array();
+        arr.emplace_back(std::forward<Args>(args)...);
+        return arr.back();
     }
 
+    // constructs a member of object in place if the key does not exist
+    template <class... Args>
+    Json& emplace(const StringRef& key, Args&&... args);
+
+    template <class Function>
+    Function for_keys(Function f) const;
+
     template <class Function>
     Function for_each(Function f) const {
-        Array &arr = array();
+        const Array &arr = array();
         return std::for_each(arr.begin(), arr.end(), f);
     }
 
@@ -133,34 +217,280 @@ public:
     std::string str() const;
 
 protected:
-    struct Dummy {
-        virtual ~Dummy() {}
-        virtual const std::type_info& type() const = 0;
-        virtual Dummy* clone() const = 0;
+    friend class JsonDocument;
+
+    typedef enum {
+        F_ARENA = 0x01, // the value and its payload belong to an arena
+        F_VIEW = 0x02, // the string refers to characters it does not own
+        F_ESCAPED = 0x04, // the characters of the view are not unescaped yet
+        F_RAW = 0x08, // the number is kept as text
+        F_CONVERTED = 0x10, // the number in the text has been converted
+        F_VALUE = F_VIEW | F_ESCAPED | F_RAW | F_CONVERTED, // flags that move with the value
+    } Flags;
+
+    // a container on the heap is shared by copies of the value and counts
+    // them. the first write through a copy clones one level, so only the
+    // path being modified is duplicated. references taken into a value must
+    // not be used to modify it after the value was copied. a container is
+    // materialized before it is shared, so copies in other threads only read.
+    struct Shared {
+        Shared() : refs(1), materialized(false) {}
+        std::atomic<uint32_t> refs;
+        bool materialized; // nothing in the container is left to build
+    };
+
+    template <typename T>
+    struct SharedBox : Shared {
+        template <class... Args>
+        explicit SharedBox(Args&&... args) : value(std::forward<Args>(args)...) {}
+        T value;
+    };
+
+    // scalars are kept inline, a string is placement-constructed in the
+    // storage and only containers live on the heap. a value in an arena
+    // keeps its string as characters in the arena and remembers the arena.
+    // a view is kept the same way, its characters are outside of any arena.
+    struct Slot {
+        union {
+            Boolean   b_;
+            Integer   i_;
+            UInteger  u_;
+            Real      r_;
+            Object   *o_;
+            Array    *a_;
+            String   *ps_; // materialized string of an arena value or a view
+        };
+        union {
+            const char *p_;  // characters of an arena string, a view or a number
+            Shared     *sh_; // reference count of a heap container
+        };
+        size_t      n_;
+        Arena      *arena_;
     };
 
-    template <typename V>
-    struct Any : Dummy {
-        Any(const V& v) : v_(v) {}
-        Any() {}
-        const std::type_info& type() const { return typeid(V); }
-        Dummy* clone() const { return new Any<V>(v_); }
-        V    v_;
+    union Storage {
+        Slot x_;
+        char s_[sizeof(String)];
     };
 
-    template <typename V>
-    Any<V>* any_cast() const {
-        if (NULL == value_) throw std::logic_error("null object");
-        if (typeid(V) == value_->type()) return static_cast<Any<V>*>(value_);
-        std::ostringstream oss;
-        oss << "type mismatch: expected " << typeid(V).name() << ", but " << value_->type().name();
-        throw std::logic_error(oss.str());
+    String& str_value() { return *reinterpret_cast<String*>(value_.s_); }
+    const String& str_value() const { return *reinterpret_cast<const String*>(value_.s_); }
+
+    Arena* arena() const { return (flags_ & F_ARENA) ? value_.x_.arena_ : NULL; }
+
+    void Expect(ValueType type) const {
+        if (type != type_) TypeMismatch(type);
+        Convert();
     }
+    // converts a number kept as text on first access. this writes a const
+    // value, which is materialized before it is shared.
+    void Convert() const {
+        if (F_RAW == (flags_ & (F_RAW | F_CONVERTED))) ConvertText();
+    }
+    void ConvertText() const;
+    void TypeMismatch(ValueType expected) const;
+    void Adopt(Arena* arena);
+    void Assign(const Json& other);
+    void MoveFrom(Json& other);
+    void MoveFrom(Json&& other) { MoveFrom(other); }
+
+    void Init() {}
+    void Init(const Json& other) { Assign(other); }
+    void Init(Json& other) { Assign(other); }
+    void Init(Json&& other) { MoveFrom(other); }
+    template <class... Args>
+    void Init(Args&&... args) { MoveFrom(Json(std::forward<Args>(args)...)); }
+    void SetString(const char* data, size_t len);
+    Array* NewArray(const Array* other = NULL);
+    Object* NewObject(const Object* other = NULL);
+    template <typename T, class... Args>
+    T* NewShared(Args&&... args) {
+        SharedBox<T> *box = new SharedBox<T>(std::forward<Args>(args)...);
+        value_.x_.sh_ = box;
+        return &box->value;
+    }
+    void Detach();
+    void Release(Shared* shared);
 
 private:
-    Dummy *value_;
+    uint8_t         type_;
+    mutable uint8_t flags_;
+    mutable Storage value_;
 };
 
+// key of an object member. the characters are immutable and shared by
+// copies of the object, the owning JsonObject counts the references.
+class JsonKey {
+public:
+    struct Data {
+        Data() : refs(1), arena(NULL) {}
+        std::atomic<uint32_t> refs;
+        Arena                *arena; // NULL on the heap
+        std::string           str;
+    };
+
+    JsonKey() : data_(NULL), hash_(0) {}
+
+    bool empty() const { return NULL == data_; }
+    const std::string& str() const { return data_->str; }
+    operator const std::string& () const { return data_->str; }
+    const char* c_str() const { return data_->str.c_str(); }
+    size_t size() const { return data_->str.size(); }
+    size_t hash() const { return hash_; }
+
+    bool operator == (const JsonKey& other) const {
+        return data_ == other.data_ || (hash_ == other.hash_ && data_->str == other.data_->str);
+    }
+    bool operator == (const StringRef& other) const {
+        return size() == other.size && 0 == memcmp(data_->str.data(), other.data, other.size);
+    }
+    bool operator != (const JsonKey& other) const { return !operator == (other); }
+    bool operator != (const StringRef& other) const { return !operator == (other); }
+    bool operator < (const JsonKey& other) const { return data_->str < other.data_->str; }
+
+    static size_t Hash(const char* data, size_t len);
+
+protected:
+    friend class JsonObject;
+    friend class JsonKeyPool;
+
+    Data   *data_;
+    size_t  hash_;
+};
+
+std::ostream& operator << (std::ostream& os, const JsonKey& key);
+
+// members of an object in one contiguous block in the order they were
+// added. small objects are scanned by comparing cached key hashes, larger
+// ones get an open addressing hash index on top of the members.
+class JsonObject {
+public:
+    struct Member {
+        Member(const JsonKey& key, const Json::allocator_type& alloc, Json&& value)
+            : first(key), second(std::allocator_arg, alloc, std::move(value)) {}
+
+        JsonKey first;
+        Json    second;
+    };
+
+    typedef Json::allocator_type allocator_type;
+    typedef Member               value_type;
+    typedef Member*              iterator;
+    typedef const Member*        const_iterator;
+
+    static const size_t INDEX_THRESHOLD = 16;
+
+    explicit JsonObject(const allocator_type& alloc = allocator_type());
+    JsonObject(const JsonObject& other);
+    JsonObject(const JsonObject& other, const allocator_type& alloc);
+    JsonObject(JsonObject&& other) noexcept;
+    JsonObject(JsonObject&& other, const allocator_type& alloc);
+    ~JsonObject();
+
+    JsonObject& operator = (const JsonObject& other);
+    JsonObject& operator = (JsonObject&& other);
+
+    allocator_type get_allocator() const { return allocator_type(arena_); }
+
+    iterator begin() { return members_; }
+    iterator end() { return members_ + size_; }
+    const_iterator begin() const { return members_; }
+    const_iterator end() const { return members_ + size_; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return 0 == size_; }
+    size_t capacity() const { return capacity_; }
+    void reserve(size_t n);
+    void clear();
+
+    iterator find(const StringRef& key);
+    const_iterator find(const StringRef& key) const;
+    iterator find(const JsonKey& key) { return members_ + Lookup(key); }
+    const_iterator find(const JsonKey& key) const { return members_ + Lookup(key); }
+    size_t count(const StringRef& key) const { return find(key) != end() ? 1 : 0; }
+    Json& at(const StringRef& key);
+    const Json& at(const StringRef& key) const;
+    Json& operator [] (const StringRef& key);
+
+    std::pair<iterator, bool> emplace(const StringRef& key, Json&& value);
+    std::pair<iterator, bool> emplace(const JsonKey& key, Json&& value);
+    size_t erase(const StringRef& key);
+    iterator erase(iterator pos);
+
+    bool operator == (const JsonObject& other) const;
+    bool operator != (const JsonObject& other) const { return !operator == (other); }
+
+protected:
+    size_t Lookup(const char* data, size_t len, size_t hash) const;
+    size_t Lookup(const JsonKey& key) const;
+    std::pair<iterator, bool> Insert(size_t pos, const JsonKey& key, Json&& value);
+    JsonKey NewKey(const char* data, size_t len, size_t hash) const;
+    JsonKey CopyKey(const JsonKey& key) const;
+    void ReleaseKey(JsonKey& key);
+    void CopyFrom(const JsonObject& other);
+    void MoveFrom(JsonObject& other);
+    void Release();
+    void BuildIndex(size_t slots);
+    void AddIndex(size_t pos);
+    void* Allocate(size_t size, size_t align);
+    void Deallocate(void* p);
+
+private:
+    Arena    *arena_;
+    Member   *members_;
+    size_t    size_;
+    size_t    capacity_;
+    uint32_t *index_;      // member position + 1, 0 for an empty slot
+    size_t    index_mask_; // number of slots - 1, 0 without index
+};
+
+// interned keys. each distinct key is stored once and shared by the
+// objects of a document or of a batch of documents, and an interned key
+// is found by comparing pointers. the pool is not thread-safe.
+class JsonKeyPool {
+public:
+    explicit JsonKeyPool(Arena* arena = NULL, size_t max_keys = 64 * 1024, size_t max_length = 256);
+    ~JsonKeyPool();
+
+    // returns an empty key if str is too long or the pool is full
+    JsonKey Intern(const StringRef& str);
+    void clear();
+
+    size_t size() const { return size_; }
+    size_t lookups() const { return lookups_; }
+    size_t hits() const { return hits_; }
+    double hit_rate() const { return lookups_ ? (double)hits_ / lookups_ : 0.0; }
+    size_t saved() const { return saved_; } // bytes not allocated for keys
+
+private:
+    JsonKeyPool(const JsonKeyPool&);
+    JsonKeyPool& operator = (const JsonKeyPool&);
+
+    void Rehash(size_t slots);
+
+    Arena   *arena_;
+    JsonKey *slots_;
+    size_t   mask_;
+    size_t   size_;
+    size_t   max_keys_;
+    size_t   max_length_;
+    size_t   lookups_;
+    size_t   hits_;
+    size_t   saved_;
+};
+
+template <class... Args>
+Json& Json::emplace(const StringRef& key, Args&&... args) {
+    return object().emplace(key, Json(std::forward<Args>(args)...)).first->second;
+}
+
+template <class Function>
+Function Json::for_keys(Function f) const {
+    const Object &obj = object();
+    for(Object::const_iterator it=obj.begin(); it!=obj.end(); ++it) f(it->first.str(), it->second);
+    return f;
+}
+
 } // namespace jslite
 
 #endif //__JSON_LITE_HPP_20121127__
\ No newline at end of file
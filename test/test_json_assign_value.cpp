@@ -70,6 +70,68 @@ int test_json_assign_value(int argc, char* argv[]) {
         jstm << json;
         LOG(jstm.str());
 
+        //Swap between a string and others
+        jslite::Json s("a string longer than the small buffer");
+        jslite::Json n((Json::Integer)100);
+        s.Swap(n);
+        EXPECT_EQ(Json::TYPE_INTEGER, s.type());
+        EXPECT_EQ(100, s.integer());
+        EXPECT_EQ(Json::TYPE_STRING, n.type());
+        EXPECT_EQ("a string longer than the small buffer", n.string());
+
+        jslite::Json copied(json);
+        EXPECT_EQ(json, copied);
+        copied[1] = "changed";
+        EXPECT_FALSE(json == copied);
+
+        //Move
+        jslite::Json moved(std::move(copied));
+        EXPECT_TRUE(copied.IsNull());
+        EXPECT_EQ((size_t)4, moved.size());
+        EXPECT_EQ("changed", moved[1].string());
+
+        jslite::Json tree;
+        tree.emplace("k1", "v1");
+        tree.emplace("k2").emplace_back((Json::Integer)1);
+        tree["k2"].put(std::move(moved));
+        EXPECT_EQ("v1", tree["k1"].string());
+        EXPECT_EQ((size_t)2, tree["k2"].size());
+        EXPECT_EQ((size_t)4, tree["k2"][1].size());
+
+        // a child moved into its own parent
+        jslite::Json parent;
+        parent["data"]["list"].put((Json::Integer)1);
+        parent["other"] = "a string longer than the small buffer";
+        parent = std::move(parent["data"]);
+        EXPECT_EQ((size_t)1, parent.size());
+        EXPECT_EQ(1, parent["list"][0].integer());
+        parent = std::move(parent["list"]);
+        parent.emplace_back().put("a string longer than the small buffer");
+        parent = std::move(parent[1]);
+        EXPECT_EQ((size_t)1, parent.size());
+        EXPECT_EQ("a string longer than the small buffer", parent[0].string());
+
+        //Copy on write
+        jslite::Json base;
+        base["conf"]["name"] = "base";
+        base["conf"]["limits"].put((Json::Integer)10);
+        base["other"]["k"] = "v";
+
+        jslite::Json request(base);
+        const Json &cbase = base, &crequest = request;
+        EXPECT_TRUE(&cbase.object() == &crequest.object());
+
+        request["conf"]["name"] = "request";
+        EXPECT_EQ("base", cbase["conf"]["name"].string());
+        EXPECT_EQ("request", crequest["conf"]["name"].string());
+        EXPECT_FALSE(&cbase["conf"].object() == &crequest["conf"].object());
+        EXPECT_TRUE(&cbase["other"].object() == &crequest["other"].object());
+        EXPECT_TRUE(&cbase["conf"]["limits"].array() == &crequest["conf"]["limits"].array());
+        EXPECT_TRUE(crequest["missing"].IsNull());
+
+        base.clear();
+        EXPECT_EQ(10, crequest["conf"]["limits"][0].integer());
+
     } catch (std::range_error &e) {
         LOG("range_error: " << e.what());
         return 1;
@@ -0,0 +1,147 @@
+#include "jtest.hpp"
+#include "json_stream.hpp"
+#include "json_document.hpp"
+#include "json_sax.hpp"
+
+#include <type_traits>
+
+int test_document_parse() {
+    jslite::JsonStream jstm;
+    jstm << "{ \"id\":7, \"a key longer than a small string\":[1, 2.5, true, null],"
+            " \"name\":\"a value longer than a small string\" }";
+
+    jslite::JsonDocument doc(256);
+    EXPECT_EQ(0, jstm.Parse(doc));
+
+    jslite::Json &root = doc.root();
+    EXPECT_TRUE(root.IsObject());
+    EXPECT_EQ(7, root["id"].integer());
+    EXPECT_EQ((size_t)4, root["a key longer than a small string"].size());
+    EXPECT_EQ(2.5, root["a key longer than a small string"][1].real());
+    EXPECT_EQ("a value longer than a small string", root["name"].string());
+    EXPECT_TRUE(0 < doc.used());
+    EXPECT_TRUE(doc.used() <= doc.reserved());
+
+    LOG("used: " << doc.used() << ", reserved: " << doc.reserved() << ", blocks: " << doc.arena().blocks());
+
+    return 0;
+}
+
+int test_document_copy_out() {
+    jslite::Json copied;
+    {
+        jslite::JsonStream jstm;
+        jstm << "{ \"list\":[\"a value longer than a small string\", {\"k\":\"v\"}] }";
+
+        jslite::JsonDocument doc;
+        EXPECT_EQ(0, jstm.Parse(doc));
+        copied = doc.root()["list"];
+
+        // values assigned into the document are kept in the arena
+        doc.root()["list"].put(jslite::Json("another value longer than a small string"));
+        doc.root()["added"]["sub"] = "and one more value longer than a small string";
+        EXPECT_EQ((size_t)3, doc.root()["list"].size());
+        EXPECT_EQ("another value longer than a small string", doc.root()["list"][2].string());
+    }
+
+    EXPECT_TRUE(copied.IsArray());
+    EXPECT_EQ((size_t)2, copied.size());
+
+    // a move assigned to a value on the heap is a copy as well, while a
+    // move-constructed value stays in the arena and never allocates
+    EXPECT_TRUE(std::is_nothrow_move_constructible<jslite::Json>::value);
+    jslite::Json assigned;
+    {
+        jslite::JsonStream jstm;
+        jslite::JsonDocument doc;
+        EXPECT_EQ(0, jstm.Parse("{\"s\":\"a value longer than a small string\",\"l\":[1]}", doc));
+        assigned = std::move(doc.root()["s"]);
+        EXPECT_TRUE(doc.root()["s"].IsNull());
+
+        jslite::Json moved(std::move(doc.root()["l"]));
+        EXPECT_TRUE(doc.root()["l"].IsNull());
+        EXPECT_EQ(1, moved[0].integer());
+        moved.put(jslite::Json((jslite::Json::Integer)2));
+        EXPECT_EQ((size_t)2, moved.size());
+    }
+    EXPECT_EQ("a value longer than a small string", assigned.string());
+    EXPECT_EQ("a value longer than a small string", copied[0].string());
+    EXPECT_EQ("v", copied[1]["k"].string());
+
+    return 0;
+}
+
+int test_document_clear() {
+    jslite::JsonDocument doc;
+    jslite::JsonStream jstm;
+    jstm << "[1, 2, 3]";
+
+    EXPECT_EQ(0, jstm.Parse(doc));
+    EXPECT_EQ((size_t)3, doc.root().size());
+
+    doc.clear();
+    EXPECT_TRUE(doc.root().IsNull());
+    EXPECT_EQ((size_t)0, doc.reserved());
+
+    EXPECT_EQ(0, jstm.Parse(doc));
+    EXPECT_EQ((size_t)3, doc.root().size());
+
+    // a block is kept for the next value
+    const size_t reserved = doc.reserved();
+    doc.reset();
+    EXPECT_TRUE(doc.root().IsNull());
+    EXPECT_EQ((size_t)0, doc.used());
+    EXPECT_EQ(reserved, doc.reserved());
+
+    EXPECT_EQ(0, jstm.Parse(doc));
+    EXPECT_EQ((size_t)3, doc.root().size());
+    EXPECT_EQ(reserved, doc.reserved());
+
+    return 0;
+}
+
+// one stream and one document for a message after another
+int test_document_reuse() {
+    jslite::JsonStream jstm;
+    jslite::JsonDocument doc(1024);
+    const std::string msg("{\"id\":1,\"name\":\"a \\\"quoted\\\" name\",\"pos\":[[1,2],[3,4]]}");
+
+    EXPECT_EQ(0, jstm.Parse(msg, doc));
+    const size_t reserved = doc.reserved();
+
+    // a message that fails in the middle leaves nothing for the next ones
+    EXPECT_EQ(jslite::ERR_ARRAY_END, jstm.Parse("{\"a\":[[1,{\"b\":[2", doc));
+    jslite::Json events;
+    jslite::JsonDomBuilder builder(events);
+    EXPECT_EQ(0, jstm.Parse("[{\"c\":3}]", static_cast<jslite::JsonHandler&>(builder)));
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(0, jstm.Parse(msg, doc));
+        EXPECT_EQ("a \"quoted\" name", doc.root()["name"].string());
+        EXPECT_EQ(4, doc.root()["pos"][1][1].integer());
+        EXPECT_EQ((size_t)3, doc.root().size());
+    }
+    EXPECT_EQ(3, events[0]["c"].integer());
+    EXPECT_EQ(reserved, doc.reserved());
+
+    // the text of the stream starts over
+    jstm << "[1,";
+    jstm.Reset();
+    EXPECT_TRUE(jstm.str().empty());
+    jstm << "[2]";
+    EXPECT_EQ(0, jstm.Parse(doc));
+    EXPECT_EQ((size_t)1, doc.root().size());
+    EXPECT_EQ(2, doc.root()[0].integer());
+
+    return 0;
+}
+
+int test_json_document(int argc, char* argv[]) {
+    EXPECT_EQ(0, test_document_parse());
+    EXPECT_EQ(0, test_document_copy_out());
+    EXPECT_EQ(0, test_document_clear());
+    EXPECT_EQ(0, test_document_reuse());
+
+    LOG("ok");
+
+    return 0;
+}
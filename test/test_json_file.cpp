@@ -0,0 +1,135 @@
+#include "jtest.hpp"
+#include "json_file.hpp"
+#include "json_document.hpp"
+#include "json_stream.hpp"
+
+#include <stdio.h>
+
+static const char *path = "test_json_file.json";
+
+static bool write_file(const std::string& text) {
+    FILE *fp = fopen(path, "wb");
+    if (NULL == fp) return false;
+    const bool ok = (text.size() == fwrite(text.data(), 1, text.size(), fp));
+    return 0 == fclose(fp) && ok;
+}
+
+int test_file_mapped() {
+    const std::string text("{ \"name\" : \"mapped\", \"list\" : [1, 2.5, \"x\\ty\"] }\n");
+    EXPECT_TRUE(write_file(text));
+
+    jslite::JsonMappedFile file;
+    EXPECT_EQ(0, file.Open(path));
+    EXPECT_EQ(text.size(), file.size());
+
+    jslite::JsonStream stream;
+    stream.set_parse_flags(jslite::PARSE_ZERO_COPY);
+    jslite::JsonDocument doc;
+    EXPECT_EQ(0, stream.Parse(file.text(), doc));
+    EXPECT_EQ("mapped", doc.root()["name"].string());
+    EXPECT_EQ("x\ty", doc.root()["list"][2].string());
+    // the string is in the mapping
+    const char *name = doc.root()["name"].string_ref().data;
+    EXPECT_TRUE(name >= file.data() && name < file.data() + file.size());
+
+    EXPECT_EQ((int32_t)jslite::ERR_FILE, file.Open("no such file.json"));
+    EXPECT_EQ(0, file.size());
+
+    return 0;
+}
+
+int test_file_records() {
+    // values one after another, and the same in an array
+    std::string lines, array("[");
+    for (int i = 0; i < 20000; ++i) {
+        const std::string record = "{\"id\":" + std::to_string(i) + ",\"name\":\"record " + std::to_string(i) +
+                                   "\",\"tags\":[\"a\",\"b\"]}";
+        lines += record + "\n";
+        array += (i ? ",\n " : "") + record;
+    }
+    array += "]\n";
+
+    for (int mode = jslite::RECORDS_VALUES; mode <= jslite::RECORDS_ARRAY; ++mode) {
+        EXPECT_TRUE(write_file(jslite::RECORDS_VALUES == mode ? lines : array));
+
+        jslite::JsonFileReader reader;
+        reader.set_parse_flags(jslite::PARSE_ZERO_COPY);
+        reader.set_release_size(4096);
+        EXPECT_EQ(0, reader.Open(path, (jslite::RecordMode)mode));
+
+        // the views of the first record outlive the release of its pages
+        jslite::Json first;
+        EXPECT_EQ(0, reader.Next(first));
+
+        int count = 1;
+        while (!reader.IsDone()) {
+            jslite::Json record;
+            if (0 != reader.Next(record) || count != record["id"].integer()) {
+                LOG("record " << count << " of mode " << mode);
+                return 1;
+            }
+            ++count;
+        }
+        EXPECT_EQ(20000, count);
+        EXPECT_EQ((size_t)20000, reader.records());
+        EXPECT_EQ(reader.file().size(), reader.offset());
+        EXPECT_EQ("record 0", first["name"].string());
+
+        jslite::Json none;
+        EXPECT_EQ((int32_t)jslite::ERR_VALUE, reader.Next(none));
+    }
+
+    return 0;
+}
+
+int test_file_errors() {
+    const struct {
+        const char          *text;
+        jslite::RecordMode   mode;
+        int                  records;
+        int32_t              err;
+    } cases[] = {
+        { "", jslite::RECORDS_VALUES, 0, 0 },
+        { "  \n", jslite::RECORDS_VALUES, 0, 0 },
+        { "1 2 3", jslite::RECORDS_VALUES, 3, 0 },
+        { "[ ]", jslite::RECORDS_ARRAY, 0, 0 },
+        { "[1, 2]", jslite::RECORDS_ARRAY, 2, 0 },
+        { "[1, 2", jslite::RECORDS_ARRAY, 1, jslite::ERR_ARRAY_END },
+        { "[1 2]", jslite::RECORDS_ARRAY, 0, jslite::ERR_ARRAY_END },
+        { "[1,]", jslite::RECORDS_ARRAY, 1, jslite::ERR_VALUE },
+        { "[1] 2", jslite::RECORDS_ARRAY, 0, jslite::ERR_VALUE },
+        { "{} [", jslite::RECORDS_VALUES, 1, jslite::ERR_VALUE },
+        { "1", jslite::RECORDS_ARRAY, 0, jslite::ERR_VALUE },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        EXPECT_TRUE(write_file(cases[i].text));
+
+        jslite::JsonFileReader reader;
+        int32_t ret = reader.Open(path, cases[i].mode);
+        int records = 0;
+        while (0 == ret && !reader.IsDone()) {
+            jslite::Json record;
+            ret = reader.Next(record);
+            if (0 == ret) ++records;
+        }
+        if (cases[i].err != ret || cases[i].records != records) {
+            LOG(cases[i].text << " is " << ret << " after " << records);
+            return 1;
+        }
+        EXPECT_TRUE(reader.IsDone());
+    }
+
+    EXPECT_EQ(0, remove(path));
+    return 0;
+}
+
+int test_json_file(int argc, char* argv[]) {
+    EXPECT_EQ(0, test_file_mapped());
+    EXPECT_EQ(0, test_file_records());
+    EXPECT_EQ(0, test_file_errors());
+
+    LOG("ok");
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include "jtest.hpp"
+#include "json_lines.hpp"
+#include "json_document.hpp"
+#include "json_stream.hpp"
+
+#include <locale.h>
+#include <stdio.h>
+#include <limits>
+#include <vector>
+
+using jslite::Json;
+using jslite::JsonLineReader;
+using jslite::JsonLineWriter;
+
+static const char *text =
+    "{\"id\":1,\"msg\":\"first\"}\n"
+    "\n"
+    "  [1, 2, 3]  \r\n"
+    "{\"id\":2, bad}\n"
+    "\"a string\"\n"
+    "1 2\n"
+    "{\"id\":3,\"tail\":true}";
+
+// results of all lines of a reader: 0 and the value, or the error
+static void read_all(JsonLineReader& reader, std::vector<int32_t>& rets, std::vector<Json>& values) {
+    int32_t ret = 0;
+    Json json;
+    while (jslite::LINES_END != (ret = reader.Next(json)) && jslite::LINES_MORE != ret) {
+        rets.push_back(ret);
+        values.push_back(0 == ret ? json : Json());
+    }
+}
+
+int test_lines_reader() {
+    JsonLineReader reader;
+    reader.Reset(text);
+    std::vector<int32_t> rets;
+    std::vector<Json> values;
+    read_all(reader, rets, values);
+
+    // bad lines do not stop the others
+    const int32_t expected[] = { 0, 0, jslite::ERR_OBJECT_KEY, 0, jslite::ERR_VALUE, 0 };
+    EXPECT_EQ(sizeof(expected) / sizeof(expected[0]), rets.size());
+    for (size_t i = 0; i < rets.size(); ++i) EXPECT_EQ(expected[i], rets[i]);
+    EXPECT_EQ("first", values[0]["msg"].string());
+    EXPECT_EQ(3, values[1].size());
+    EXPECT_EQ("a string", values[3].string());
+    EXPECT_TRUE(values[5]["tail"].boolean());
+    EXPECT_EQ((size_t)6, reader.records());
+    EXPECT_EQ((size_t)2, reader.errors());
+    EXPECT_EQ((size_t)7, reader.line());
+    EXPECT_EQ((int32_t)jslite::LINES_END, reader.Next(values[0]));
+
+    // any split of the text gives the same records
+    const std::string str(text);
+    for (size_t size = 1; size <= str.size(); ++size) {
+        JsonLineReader chunked;
+        std::vector<int32_t> chunk_rets;
+        std::vector<Json> chunk_values;
+        for (size_t pos = 0; pos < str.size(); pos += size) {
+            chunked.Feed(str.substr(pos, size));
+            read_all(chunked, chunk_rets, chunk_values);
+        }
+        EXPECT_EQ((int32_t)jslite::LINES_MORE, chunked.Next(values[0]));
+        chunked.Finish();
+        read_all(chunked, chunk_rets, chunk_values);
+
+        if (rets != chunk_rets || !(values == chunk_values)) {
+            LOG("chunks of " << size);
+            return 1;
+        }
+    }
+
+    // a document keeps its memory from one record to the next
+    std::string same;
+    for (int i = 0; i < 100; ++i) same += "{\"values\":[1,2,3,4,5,6,7,8],\"name\":\"a name long enough\"}\n";
+    reader.Reset(same);
+    jslite::JsonDocument doc;
+    EXPECT_EQ(0, reader.Next(doc));
+    const size_t reserved = doc.reserved();
+    while (0 == reader.Next(doc)) {
+        if (reserved != doc.reserved() || 8 != doc.root()["values"].size()) return 1;
+    }
+    EXPECT_EQ((size_t)100, reader.records());
+
+    return 0;
+}
+
+int test_lines_file() {
+    const char *path = "test_json_lines.json";
+    FILE *fp = fopen(path, "wb");
+    EXPECT_TRUE(NULL != fp);
+    fputs(text, fp);
+    fclose(fp);
+
+    JsonLineReader reader;
+    EXPECT_EQ(0, reader.Open(path));
+    std::vector<int32_t> rets;
+    std::vector<Json> values;
+    read_all(reader, rets, values);
+    EXPECT_EQ((size_t)6, rets.size());
+    EXPECT_EQ(3, values[5]["id"].integer());
+
+    EXPECT_EQ(0, remove(path));
+    EXPECT_EQ((int32_t)jslite::ERR_FILE, reader.Open(path));
+    EXPECT_EQ((int32_t)jslite::LINES_END, reader.Next(values[0]));
+
+    return 0;
+}
+
+int test_lines_writer() {
+    Json record;
+    record["z"] = "first \"key\"\n\t\x01";
+    record["a"] = Json::Array();
+    record["a"].put((Json::Integer)std::numeric_limits<int64_t>::min());
+    record["a"].put(std::numeric_limits<uint64_t>::max());
+    record["a"].put(0.1);
+    record["a"].put(1e300);
+    record["a"].put(-2.5);
+    record["a"].put(3.0);
+    record["a"].put(Json());
+    record["a"].put(false);
+    record["o"] = Json::Object();
+
+    JsonLineWriter writer;
+    EXPECT_EQ(0, writer.Write(record));
+    EXPECT_EQ(0, writer.Write("second"));
+    // members in the order they were added, reals as short as they can be
+    EXPECT_EQ("{\"z\":\"first \\\"key\\\"\\n\\t\\u0001\",\"a\":[-9223372036854775808,18446744073709551615,"
+              "0.1,1e+300,-2.5,3.0,null,false],\"o\":{}}\n\"second\"\n", writer.str());
+
+    // the same reals in a locale with a decimal comma
+    const char *names[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR" };
+    const char *locale = NULL;
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]) && NULL == locale; ++i) locale = setlocale(LC_NUMERIC, names[i]);
+    if (NULL == locale) {
+        LOG("no locale with a decimal comma");
+    } else {
+        Json reals = Json::Array();
+        reals.put(1.5);
+        reals.put(0.1 + 0.2);
+        reals.put(-2.5e-7);
+        JsonLineWriter comma;
+        const int32_t ret = comma.Write(reals);
+        setlocale(LC_NUMERIC, "C");
+        EXPECT_EQ(0, ret);
+        EXPECT_EQ("[1.5,0.30000000000000004,-2.5e-07]\n", comma.str());
+    }
+
+    // nothing is left of a record that can not be written
+    Json bad = Json::Array();
+    bad.put((Json::Integer)1);
+    bad.put(std::numeric_limits<double>::infinity());
+    const size_t size = writer.size();
+    EXPECT_EQ((int32_t)jslite::ERR_JSON_TYPE, writer.Write(bad));
+    EXPECT_EQ(size, writer.size());
+    EXPECT_EQ((size_t)2, writer.records());
+
+    // what is written reads back the same
+    for (int i = 0; i < 1000; ++i) {
+        Json json;
+        json["id"] = i;
+        json["real"] = i / 7.0;
+        json["text"] = std::string(i % 5, '"') + "\\";
+        writer.Write(json);
+    }
+    JsonLineReader reader;
+    reader.Reset(writer.str());
+    Json json;
+    EXPECT_EQ(0, reader.Next(json));
+    EXPECT_EQ(record, json);
+    EXPECT_EQ(0, reader.Next(json));
+    for (int i = 0; i < 1000; ++i) {
+        if (0 != reader.Next(json) || i != json["id"].integer() || i / 7.0 != json["real"].real()) {
+            LOG("record " << i);
+            return 1;
+        }
+    }
+    EXPECT_EQ((int32_t)jslite::LINES_END, reader.Next(json));
+
+    std::string out;
+    writer.swap(out);
+    EXPECT_EQ((size_t)0, writer.size());
+    EXPECT_EQ((size_t)0, writer.records());
+    EXPECT_FALSE(out.empty());
+
+    return 0;
+}
+
+int test_json_lines(int argc, char* argv[]) {
+    EXPECT_EQ(0, test_lines_reader());
+    EXPECT_EQ(0, test_lines_file());
+    EXPECT_EQ(0, test_lines_writer());
+
+    LOG("ok");
+
+    return 0;
+}
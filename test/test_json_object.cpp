@@ -0,0 +1,158 @@
+#include "jtest.hpp"
+#include "jsonlite.hpp"
+#include "json_stream.hpp"
+#include "json_document.hpp"
+
+#include <stdio.h>
+
+using jslite::Json;
+
+static std::string key_of(int i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "key_%d", i);
+    return buf;
+}
+
+int test_object_small() {
+    Json json;
+    json["b"] = 2;
+    json["a"] = 1;
+    json["c"] = 3;
+
+    Json::Object &obj = json.object();
+    EXPECT_EQ((size_t)3, obj.size());
+    EXPECT_TRUE(obj.find("a") != obj.end());
+    EXPECT_TRUE(obj.find("d") == obj.end());
+    EXPECT_EQ((size_t)1, obj.count("c"));
+    EXPECT_EQ(2, obj.at("b").integer());
+
+    json.remove_by("a");
+    EXPECT_EQ((size_t)2, obj.size());
+    EXPECT_TRUE(obj.find("a") == obj.end());
+    EXPECT_EQ(2, json["b"].integer());
+    EXPECT_EQ(3, json["c"].integer());
+
+    return 0;
+}
+
+int test_object_indexed() {
+    const int count = 100;
+    Json json;
+
+    for (int i = 0; i < count; ++i) json[key_of(i)] = (Json::Integer)i;
+    EXPECT_EQ((size_t)count, json.size());
+
+    for (int i = 0; i < count; ++i) {
+        if (i != json[key_of(i)].integer()) return 1;
+    }
+
+    for (int i = 0; i < count; i += 2) json.remove_by(key_of(i));
+    EXPECT_EQ((size_t)count / 2, json.size());
+
+    for (int i = 0; i < count; ++i) {
+        bool found = json.object().count(key_of(i)) == 1;
+        if (found != (1 == i % 2)) return 1;
+    }
+
+    // equality does not depend on the order of members
+    Json other;
+    for (int i = count - 1; i >= 0; --i) {
+        if (i % 2) other[key_of(i)] = (Json::Integer)i;
+    }
+    EXPECT_EQ(json, other);
+
+    Json copied(json);
+    EXPECT_EQ(json, copied);
+    copied[key_of(1)] = (Json::Integer)-1;
+    EXPECT_FALSE(json == copied);
+    EXPECT_EQ(1, json[key_of(1)].integer());
+
+    return 0;
+}
+
+int test_object_for_keys() {
+    Json json;
+    json["k1"] = "v1";
+    json["k2"] = "v2";
+
+    std::string keys;
+    json.for_keys([&keys](const std::string& key, const Json& value) { keys += key; });
+    EXPECT_EQ((size_t)4, keys.size());
+
+    return 0;
+}
+
+int test_object_insertion_order() {
+    jslite::JsonStream parser;
+    parser << "{\"b\":1,\"a\":2,\"d\":3,\"c\":4}";
+
+    Json json;
+    EXPECT_TRUE(0 == parser.Parse(json));
+
+    jslite::JsonStream jss;
+    jss << jslite::insertion_keys << json;
+    EXPECT_EQ("{\"b\":1,\"a\":2,\"d\":3,\"c\":4}", jss.str());
+
+    json.remove_by("a");
+    json["e"] = 5;
+    jss.str("");
+    jss << json;
+    EXPECT_EQ("{\"b\":1,\"d\":3,\"c\":4,\"e\":5}", jss.str());
+
+    jss.str("");
+    jss << jslite::sorted_keys << json;
+    EXPECT_EQ("{\"b\":1,\"c\":4,\"d\":3,\"e\":5}", jss.str());
+
+    return 0;
+}
+
+int test_object_key_pool() {
+    const char *text = "[{\"id\":1,\"n\\u0061me\":\"a\"},{\"id\":2,\"name\":\"b\"},{\"id\":3,\"name\":\"c\"}]";
+
+    jslite::JsonKeyPool pool;
+    Json json;
+    {
+        jslite::JsonStream parser;
+        parser.set_key_pool(&pool);
+        parser << text;
+        EXPECT_TRUE(0 == parser.Parse(json));
+    }
+    EXPECT_EQ((size_t)2, pool.size());
+    EXPECT_EQ((size_t)6, pool.lookups());
+    EXPECT_EQ((size_t)4, pool.hits());
+    EXPECT_TRUE(pool.saved() > 0);
+
+    // records share one copy of each key
+    const Json::Object &first = json[0].object();
+    const Json::Object &last = json[2].object();
+    EXPECT_TRUE(first.begin()->first.c_str() == last.begin()->first.c_str());
+    EXPECT_TRUE((first.begin() + 1)->first.c_str() == (last.begin() + 1)->first.c_str());
+    EXPECT_EQ("a", json[0]["name"].string());
+
+    // keys outlive the pool
+    pool.clear();
+    EXPECT_EQ((size_t)0, pool.size());
+    EXPECT_EQ(3, json[2]["id"].integer());
+
+    jslite::JsonDocument doc;
+    jslite::JsonStream parser;
+    parser << text;
+    EXPECT_TRUE(0 == parser.Parse(doc));
+    EXPECT_EQ((size_t)2, doc.keys().size());
+    EXPECT_TRUE(doc.root()[0].object().begin()->first.c_str() == doc.root()[1].object().begin()->first.c_str());
+    EXPECT_EQ(json, doc.root());
+
+    return 0;
+}
+
+int test_json_object(int argc, char* argv[]) {
+    EXPECT_EQ(0, test_object_small());
+    EXPECT_EQ(0, test_object_indexed());
+    EXPECT_EQ(0, test_object_for_keys());
+    EXPECT_EQ(0, test_object_insertion_order());
+    EXPECT_EQ(0, test_object_key_pool());
+
+    LOG("ok");
+
+    return 0;
+}
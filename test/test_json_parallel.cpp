@@ -0,0 +1,227 @@
+#include "jtest.hpp"
+#include "json_parallel.hpp"
+#include "json_lines.hpp"
+#include "json_stream.hpp"
+
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using jslite::Json;
+using jslite::JsonLineBatch;
+using jslite::JsonParallelReader;
+
+// lines of records, with blank and bad ones among them
+static std::string make_text(int count) {
+    std::string text;
+    for (int i = 0; i < count; ++i) {
+        if (0 == i % 97) text += "\n";
+        if (0 == i % 251) {
+            text += "{\"id\":" + std::to_string(i) + ", bad}\n";
+            continue;
+        }
+        text += "{\"id\":" + std::to_string(i) + ",\"name\":\"record " + std::to_string(i) +
+                "\",\"values\":[" + std::to_string(i % 7) + ",true,null]}\n";
+    }
+    return text;
+}
+
+// all records of the reader with the batches in order of their chunks
+static int read_all(JsonParallelReader& reader, std::vector<Json>& records, size_t& errors) {
+    std::vector<std::vector<Json> > chunks;
+    errors = 0;
+    while (const JsonLineBatch *batch = reader.Next()) {
+        if (chunks.size() <= batch->seq()) chunks.resize(batch->seq() + 1);
+        std::vector<Json> &chunk = chunks[batch->seq()];
+        for (size_t i = 0; i < batch->size(); ++i) chunk.push_back((*batch)[i]);
+
+        for (size_t i = 0; i < batch->errors().size(); ++i) {
+            const JsonLineBatch::Error &error = batch->errors()[i];
+            if (!(*batch)[error.index].IsNull() || jslite::ERR_OBJECT_KEY != error.error) return 1;
+            ++errors;
+        }
+    }
+    for (size_t i = 0; i < chunks.size(); ++i) records.insert(records.end(), chunks[i].begin(), chunks[i].end());
+    return 0;
+}
+
+int test_parallel_reader() {
+    const std::string text = make_text(5000);
+
+    // what one reader of the lines gives
+    std::vector<Json> expected;
+    jslite::JsonLineReader lines;
+    lines.Reset(text);
+    Json json;
+    int32_t ret = 0;
+    while (jslite::LINES_END != (ret = lines.Next(json))) expected.push_back(0 == ret ? json : Json());
+    EXPECT_EQ((size_t)5000, expected.size());
+
+    const size_t threads[] = { 1, 2, 4 };
+    const size_t chunk_sizes[] = { 1, 100, 4096, 1024 * 1024 };
+    for (size_t t = 0; t < 3; ++t) {
+        for (size_t c = 0; c < 4; ++c) {
+            for (int order = jslite::ORDER_INPUT; order <= jslite::ORDER_ANY; ++order) {
+                JsonParallelReader reader(threads[t]);
+                reader.set_chunk_size(chunk_sizes[c]);
+                reader.set_order((jslite::BatchOrder)order);
+                reader.set_window(2);
+                reader.Reset(text);
+
+                std::vector<Json> records;
+                size_t errors = 0;
+                EXPECT_EQ(0, read_all(reader, records, errors));
+                if (expected != records || lines.errors() != errors || lines.errors() != reader.errors()) {
+                    LOG("threads " << threads[t] << ", chunk size " << chunk_sizes[c] << ", order " << order);
+                    return 1;
+                }
+                EXPECT_EQ(expected.size(), reader.records());
+            }
+        }
+    }
+
+    // in order, batches come as the chunks follow each other
+    JsonParallelReader reader(3);
+    reader.set_chunk_size(1000);
+    reader.Reset(text);
+    size_t seq = 0, offset = 0, lines_read = 0;
+    while (const JsonLineBatch *batch = reader.Next()) {
+        EXPECT_EQ(seq++, batch->seq());
+        EXPECT_EQ(offset, batch->offset());
+        lines_read += batch->lines();
+        // the next chunk starts after the last newline of this one
+        offset = text.find('\n', std::min(text.size(), offset + 1000));
+        offset = (std::string::npos == offset ? text.size() : offset + 1);
+    }
+    EXPECT_EQ(text.size(), offset);
+    EXPECT_EQ(lines.line(), lines_read);
+    EXPECT_EQ(seq, reader.batches());
+    EXPECT_TRUE(NULL == reader.Next());
+
+    // the reader can be stopped with batches left and used again
+    reader.Reset(text);
+    EXPECT_TRUE(NULL != reader.Next());
+    reader.Close();
+    EXPECT_TRUE(NULL == reader.Next());
+    reader.Reset("");
+    EXPECT_TRUE(NULL == reader.Next());
+    reader.Reset("[1]\n2");
+    EXPECT_EQ(2, reader.Next()->size());
+
+    return 0;
+}
+
+int test_parallel_file() {
+    const char *path = "test_json_parallel.json";
+    const std::string text = make_text(2000);
+    FILE *fp = fopen(path, "wb");
+    EXPECT_TRUE(NULL != fp);
+    fwrite(text.data(), 1, text.size(), fp);
+    fclose(fp);
+
+    JsonParallelReader reader(2);
+    reader.set_chunk_size(512);
+    reader.set_parse_flags(jslite::PARSE_ZERO_COPY | jslite::PARSE_LAZY_NUMBERS);
+    EXPECT_EQ(0, reader.Open(path));
+    int id = 0;
+    while (const JsonLineBatch *batch = reader.Next()) {
+        for (size_t i = 0; i < batch->size(); ++i, ++id) {
+            if (0 == id % 251) continue;
+            if (id != (*batch)[i]["id"].integer() || "record " + std::to_string(id) != (*batch)[i]["name"].string()) {
+                LOG("record " << id);
+                return 1;
+            }
+        }
+    }
+    EXPECT_EQ(2000, id);
+
+    EXPECT_EQ(0, remove(path));
+    EXPECT_EQ((int32_t)jslite::ERR_FILE, reader.Open(path));
+    EXPECT_TRUE(NULL == reader.Next());
+
+    return 0;
+}
+
+// the same result and error as one thread parsing text
+static int parse_same(const std::string& text, size_t threads, size_t chunk_size, uint32_t flags = jslite::PARSE_DEFAULT) {
+    jslite::JsonStream stream;
+    stream.set_parse_flags(flags);
+    Json expected;
+    int32_t expected_ret = stream.Parse(text, expected);
+
+    jslite::JsonParallelParser parser(threads);
+    parser.set_chunk_size(chunk_size);
+    parser.set_parse_flags(flags);
+    Json json = "not cleared";
+    int32_t ret = parser.Parse(text, json);
+    if (expected_ret != ret || (0 == ret && !(expected == json))) {
+        LOG("text " << text.substr(0, 40) << ", threads " << threads << ", chunk size " << chunk_size << ": " << ret);
+        return 1;
+    }
+    return 0;
+}
+
+int test_parallel_array() {
+    // strings with brackets, commas and escaped quotes in them
+    std::string text = " [";
+    for (int i = 0; i < 3000; ++i) {
+        if (i) text += (i % 3 ? "," : " ,\n ");
+        switch(i % 5) {
+        case 0: text += "{\"id\":" + std::to_string(i) + ",\"s\":\"],}{[\\\"\\\\\",\"a\":[1,[2,{}]]}"; break;
+        case 1: text += "\"\\\\\""; break;
+        case 2: text += std::to_string(i * 0.5); break;
+        case 3: text += "[]"; break;
+        default: text += "null"; break;
+        }
+    }
+    text += "] \n";
+
+    const size_t chunk_sizes[] = { 1, 64, 5000, 1024 * 1024 };
+    for (size_t c = 0; c < 4; ++c) {
+        EXPECT_EQ(0, parse_same(text, 3, chunk_sizes[c]));
+        EXPECT_EQ(0, parse_same(text, 2, chunk_sizes[c], jslite::PARSE_ZERO_COPY | jslite::PARSE_LAZY_NUMBERS));
+    }
+
+    jslite::JsonParallelParser parser(4);
+    parser.set_chunk_size(1000);
+    Json json;
+    EXPECT_EQ(0, parser.Parse(text, json));
+    EXPECT_EQ(3000, json.size());
+    EXPECT_EQ("],}{[\"\\", json[2995]["s"].string());
+    EXPECT_TRUE(parser.ranges() > 10);
+
+    // texts that are not split, and bad ones, give what one thread gives
+    const char *texts[] = {
+        "[]", " [ ] ", "[1]", "{\"a\":[1,2]}", "1", "", "[1,/*,*/2]", "[1,]", "[,1]", "[1,2",
+        "[{]}", "[1}", "[\"a\\\"]\"", "[\"a", "[\"\\", "[1] x", "[[1],[2,]]", "[1,\"\x01\"]",
+    };
+    for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); ++i) {
+        EXPECT_EQ(0, parse_same(texts[i], 2, 1));
+    }
+
+    // the depth counts the array around the elements
+    parser.set_chunk_size(1);
+    parser.set_max_depth(2);
+    EXPECT_EQ(0, parser.Parse("[[1],[2]]", json));
+    EXPECT_EQ(2, parser.ranges());
+    EXPECT_EQ((int32_t)jslite::ERR_OVERFLOW, parser.Parse("[[1],[[2]]]", json));
+
+    // a value of a document is parsed by one thread
+    jslite::JsonDocument doc;
+    EXPECT_EQ(0, parser.Parse("[[1],[2]]", doc.root()));
+    EXPECT_EQ(0, parser.ranges());
+    EXPECT_EQ(2, doc.root()[1][0].integer());
+
+    return 0;
+}
+
+int test_json_parallel(int argc, char* argv[]) {
+    EXPECT_EQ(0, test_parallel_reader());
+    EXPECT_EQ(0, test_parallel_file());
+    EXPECT_EQ(0, test_parallel_array());
+
+    LOG("ok");
+
+    return 0;
+}
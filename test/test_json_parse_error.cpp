@@ -2,6 +2,9 @@
 #include "json_stream.hpp"
 #include "json_util.hpp"
 
+#include <string.h>
+#include <vector>
+
 int test_error_value() {
 	jslite::JsonStream jstm;
 	jslite::Json json;
@@ -100,6 +103,23 @@ int test_error_object_end() {
 	return 0;
 }
 
+// the text of the caller ends where it is cut, without a NUL after it
+int test_error_caller_text() {
+	jslite::JsonStream jstm;
+	jslite::Json json;
+
+	std::vector<char> text(4);
+	memcpy(&text[0], "[1, ", 4);
+
+	int32_t ret = jstm.Parse(&text[0], text.size(), json);
+	EXPECT_FALSE((ret == 0));
+	const std::string msg = jstm.strerror(ret);
+	LOG(msg);
+	EXPECT_TRUE(std::string::npos != msg.find("EOF: \"\" at Line: 0, Column: 4"));
+
+	return 0;
+}
+
 int test_json_parse_error(int argc, char* argv[]) {
 	EXPECT_EQ(0, test_error_value());
 	EXPECT_EQ(0, test_error_esc_char());
@@ -108,6 +128,7 @@ int test_json_parse_error(int argc, char* argv[]) {
 	EXPECT_EQ(0, test_error_object_key());
 	EXPECT_EQ(0, test_error_object_sep());
 	EXPECT_EQ(0, test_error_object_end());
+	EXPECT_EQ(0, test_error_caller_text());
     
     LOG("ok");
 
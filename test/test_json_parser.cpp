@@ -1,6 +1,8 @@
 #include "jtest.hpp"
 #include "json_stream.hpp"
 #include "json_util.hpp"
+#include "json_document.hpp"
+#include <thread>
 
 
 int test_empty_array() {
@@ -62,6 +64,19 @@ int test_simple_object() {
 }
 
 
+int test_duplicated_key() {
+    jslite::JsonStream parser;
+    parser << "{ \"k\":1, \"k\":\"v\" }";
+
+    jslite::Json json;
+
+    EXPECT_TRUE(0 == parser.Parse(json));
+    EXPECT_EQ(1, json.length());
+    EXPECT_EQ("v", json["k"].string());
+
+    return 0;
+}
+
 int test_empty_string() {
     jslite::JsonStream parser;
 
@@ -224,16 +239,259 @@ int test_simple_comment() {
 }
 
 
+int test_zero_copy_string() {
+    jslite::JsonStream parser;
+    parser.set_parse_flags(jslite::PARSE_ZERO_COPY);
+    parser << "{ \"plain\":\"text\", \"escaped\":\"a\\tb\\u0041\", \"list\":[\"x\",\"y\"] }";
+
+    jslite::Json json;
+    EXPECT_TRUE(0 == parser.Parse(json));
+    EXPECT_EQ("text", json["plain"].string());
+    EXPECT_EQ((size_t)4, json["escaped"].string_ref().size);
+    EXPECT_EQ("a\tbA", json["escaped"].string());
+    EXPECT_EQ("y", json["list"][1].string());
+
+    // copies own their characters, moves keep the view
+    jslite::Json copied(json);
+    jslite::Json moved(std::move(json["plain"]));
+    EXPECT_EQ("text", moved.string());
+    moved = "changed";
+    EXPECT_EQ("changed", moved.string());
+
+    jslite::JsonDocument doc;
+    EXPECT_TRUE(0 == parser.Parse(doc));
+    EXPECT_EQ("a\tbA", doc.root()["escaped"].string());
+
+    jslite::Json other;
+    parser.str("{ \"plain\":\"other\" }");
+    EXPECT_TRUE(0 == parser.Parse(other));
+    EXPECT_EQ("text", copied["plain"].string());
+    EXPECT_EQ("a\tbA", copied["escaped"].string());
+    EXPECT_EQ("x", copied["list"][0].string());
+
+    // copies read by other threads build nothing
+    jslite::Json tree;
+    parser.str("{ \"list\":[\"one\", \"t\\u0077o\"] }");
+    EXPECT_TRUE(0 == parser.Parse(tree));
+    jslite::Json copies[2] = { tree, tree };
+    std::string read[2];
+    std::thread readers[2];
+    for (int i = 0; i < 2; ++i) {
+        readers[i] = std::thread([&copies, &read, i]() {
+            const jslite::Json &list = copies[i]["list"];
+            read[i] = list[0].string() + list[1].string();
+        });
+    }
+    for (int i = 0; i < 2; ++i) readers[i].join();
+    EXPECT_EQ("onetwo", read[0]);
+    EXPECT_EQ("onetwo", read[1]);
+
+    // escapes are still checked while parsing
+    jslite::Json bad;
+    parser.str("\"bad\\q\"");
+    EXPECT_EQ((int32_t)jslite::ERR_ESC_CHAR, parser.Parse(bad));
+
+    return 0;
+}
+
+int test_external_text() {
+    const std::string text("{ \"name\":\"outside\", \"list\":[1, 2.5, \"a\\\"b\"] }");
+    jslite::JsonStream parser;
+    jslite::Json expected, json;
+    parser << text;
+    EXPECT_TRUE(0 == parser.Parse(expected));
+
+    // the text of the stream is left as it was
+    EXPECT_TRUE(0 == parser.Parse(text.data(), text.size(), json));
+    EXPECT_EQ(expected, json);
+    EXPECT_EQ(text, parser.str());
+
+    // views point into the text of the caller
+    parser.set_parse_flags(jslite::PARSE_ZERO_COPY | jslite::PARSE_LAZY_NUMBERS);
+    jslite::JsonDocument doc;
+    EXPECT_TRUE(0 == parser.Parse(text, doc));
+    EXPECT_EQ(expected, doc.root());
+    EXPECT_TRUE(doc.root()["name"].string_ref().data == text.data() + text.find("outside"));
+
+    // the text needs no terminating NUL
+    const char chunk[] = { '[', '1', ',', '2', ']', '1' };
+    jslite::Json list, bad;
+    EXPECT_TRUE(0 == parser.Parse(chunk, 5, list));
+    EXPECT_EQ(2, list.size());
+
+    EXPECT_EQ((int32_t)jslite::ERR_ARRAY_END, parser.Parse(jslite::StringRef("[1 2]"), bad));
+    EXPECT_TRUE(std::string::npos != parser.strerror(jslite::ERR_ARRAY_END).find("Column"));
+
+    return 0;
+}
+
+int test_presize_arrays() {
+    const char *text = "[ [1,2,3], [], {\"a\":[1,\"x,]\",[2]]}, /* [, */ 5 ]";
+
+    jslite::JsonStream parser;
+    parser.set_parse_flags(jslite::PARSE_PRESIZE_ARRAYS);
+    parser << text;
+    jslite::Json json;
+    EXPECT_TRUE(0 == parser.Parse(json));
+    EXPECT_EQ((size_t)4, json.capacity());
+    EXPECT_EQ((size_t)3, json[0].capacity());
+    EXPECT_EQ((size_t)0, json[1].capacity());
+    EXPECT_EQ((size_t)3, json[2]["a"].capacity());
+    EXPECT_EQ((size_t)1, json[2]["a"][2].capacity());
+
+    jslite::JsonStream plain;
+    plain << text;
+    jslite::Json expected;
+    EXPECT_TRUE(0 == plain.Parse(expected));
+    EXPECT_EQ(expected, json);
+
+    // indexes beyond 16 bits
+    std::string big("[0");
+    for (int i = 1; i < 70000; ++i) big += "," + std::to_string(i);
+    big += "]";
+    parser.str(big);
+    jslite::Json numbers;
+    EXPECT_TRUE(0 == parser.Parse(numbers));
+    EXPECT_EQ((size_t)70000, numbers.capacity());
+    EXPECT_EQ(69999, numbers[(size_t)69999].integer());
+
+    // a text of the caller that ends in a string, after a backslash
+    const char cut[] = { '[', '"', '\\' };
+    EXPECT_TRUE(0 != parser.Parse(cut, sizeof(cut), numbers));
+
+    return 0;
+}
+
+int test_lazy_number() {
+    const char *text = "[1, -42, 12345678901, 0.10000000000000000555, 1e400, 2.5E-3]";
+
+    jslite::JsonStream parser;
+    parser.set_parse_flags(jslite::PARSE_LAZY_NUMBERS);
+    parser << text;
+
+    jslite::Json json;
+    EXPECT_TRUE(0 == parser.Parse(json));
+    EXPECT_EQ(jslite::Json::TYPE_INTEGER, json[0].type());
+    EXPECT_EQ(jslite::Json::TYPE_UINTEGER, json[2].type());
+    EXPECT_EQ(jslite::Json::TYPE_REAL, json[3].type());
+    EXPECT_EQ(-42, json[1].integer());
+    EXPECT_EQ(12345678901ULL, json[2].uinteger());
+    EXPECT_EQ(0.0025, json[5].real());
+
+    // unmodified numbers keep their digits
+    jslite::JsonStream printer;
+    printer << json;
+    EXPECT_EQ("[1,-42,12345678901,0.10000000000000000555,1e400,2.5E-3]", printer.str());
+
+    jslite::Json copied(json);
+    EXPECT_EQ(json, copied);
+    EXPECT_TRUE(NULL == copied[1].number_ref().data);
+
+    json[1] = (jslite::Json::Integer)7;
+    EXPECT_TRUE(NULL == json[1].number_ref().data);
+    printer.str("");
+    printer << json[1];
+    EXPECT_EQ("7", printer.str());
+
+    // copies read by other threads convert nothing
+    jslite::Json reals;
+    parser.str("[0.5, 1e-2]");
+    EXPECT_TRUE(0 == parser.Parse(reals));
+    jslite::Json copies[2] = { reals, reals };
+    double sums[2] = { 0, 0 };
+    std::thread readers[2];
+    for (int i = 0; i < 2; ++i) {
+        readers[i] = std::thread([&copies, &sums, i]() {
+            const jslite::Json &list = copies[i];
+            sums[i] = list[0].real() + list[1].real();
+        });
+    }
+    for (int i = 0; i < 2; ++i) readers[i].join();
+    EXPECT_EQ(0.51, sums[0]);
+    EXPECT_EQ(0.51, sums[1]);
+
+    jslite::Json bad;
+    parser.str("[1.2.3]");
+    EXPECT_EQ((int32_t)jslite::ERR_NUMBER, parser.Parse(bad));
+
+    return 0;
+}
+
+int test_number_grammar() {
+    const char *bad[] = { "+1", "01", "-", "1.", "1e", "1e+", "1-2", "1.2.3", "-01", "1ee2" };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        jslite::JsonStream parser;
+        parser << bad[i];
+        jslite::Json json;
+        EXPECT_EQ((int32_t)jslite::ERR_NUMBER, parser.Parse(json));
+    }
+
+    jslite::JsonStream parser;
+    parser << "[0, -0, 999999999, 1000000000, -9223372036854775808, 18446744073709551615,"
+              " -9223372036854775809, 18446744073709551616, 0.1, 1e-400, 1e400, 2.2250738585072011e-308,"
+              " 9007199254740993.0, 123456789012345678901234567890e-20, 0.000123E+2]";
+    jslite::Json json;
+    EXPECT_TRUE(0 == parser.Parse(json));
+    EXPECT_EQ(jslite::Json::TYPE_INTEGER, json[(size_t)2].type());
+    EXPECT_EQ(jslite::Json::TYPE_UINTEGER, json[(size_t)3].type());
+    EXPECT_EQ(INT64_MIN, json[(size_t)4].integer());
+    EXPECT_EQ(UINT64_MAX, json[(size_t)5].uinteger());
+    EXPECT_EQ(jslite::Json::TYPE_REAL, json[(size_t)6].type());
+    EXPECT_EQ(jslite::Json::TYPE_REAL, json[(size_t)7].type());
+    EXPECT_EQ(18446744073709551616.0, json[(size_t)7].real());
+    EXPECT_EQ(0.1, json[(size_t)8].real());
+    EXPECT_EQ(0.0, json[(size_t)9].real());
+    EXPECT_TRUE(json[(size_t)10].real() > 1.7976931348623157e308);
+    EXPECT_EQ(2.2250738585072011e-308, json[(size_t)11].real());
+    EXPECT_EQ(9007199254740992.0, json[(size_t)12].real());
+    EXPECT_EQ(1234567890.1234567890, json[(size_t)13].real());
+    EXPECT_EQ(0.0123, json[(size_t)14].real());
+
+    return 0;
+}
+
+int test_number_random() {
+    // the same doubles as strtod()
+    srand(20150115);
+    char buf[64];
+    for (int i = 0; i < 20000; ++i) {
+        uint64_t bits = ((uint64_t)rand() << 62) ^ ((uint64_t)rand() << 31) ^ (uint64_t)rand();
+        double expected = 0.0;
+        memcpy(&expected, &bits, sizeof(expected));
+        if (!(expected - expected == 0.0)) continue; // nan or infinity
+        snprintf(buf, sizeof(buf), "%.*e", i % 17, expected);
+        expected = strtod(buf, NULL);
+
+        jslite::JsonStream parser;
+        parser << buf;
+        jslite::Json json;
+        EXPECT_TRUE(0 == parser.Parse(json));
+        const double value = json.real();
+        if (0 != memcmp(&expected, &value, sizeof(expected))) {
+            LOG("number " << buf);
+            return 1;
+        }
+    }
+    return 0;
+}
+
 int test_json_parser(int argc, char* argv[]) {
     EXPECT_EQ(0, test_empty_array());
     EXPECT_EQ(0, test_empty_object());
     EXPECT_EQ(0, test_simple_object());
+    EXPECT_EQ(0, test_duplicated_key());
     EXPECT_EQ(0, test_empty_string());
     EXPECT_EQ(0, test_unicode_string());
     EXPECT_EQ(0, test_simple_string());
     EXPECT_EQ(0, test_simple_integer());
     EXPECT_EQ(0, test_simple_real());
     EXPECT_EQ(0, test_simple_comment());
+    EXPECT_EQ(0, test_zero_copy_string());
+    EXPECT_EQ(0, test_external_text());
+    EXPECT_EQ(0, test_presize_arrays());
+    EXPECT_EQ(0, test_lazy_number());
+    EXPECT_EQ(0, test_number_grammar());
+    EXPECT_EQ(0, test_number_random());
     
     LOG("ok");
 
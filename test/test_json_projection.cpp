@@ -0,0 +1,170 @@
+#include "jtest.hpp"
+#include "json_projection.hpp"
+#include "json_document.hpp"
+#include "json_lines.hpp"
+#include "json_sax.hpp"
+#include "json_stream.hpp"
+
+#include <string>
+#include <vector>
+
+using jslite::Json;
+using jslite::JsonProjection;
+using jslite::JsonStream;
+
+static const char *text =
+    "{\"user\":{\"id\":7,\"name\":\"a \\\"b\\\"\",\"tags\":[\"x\"]},"
+    "\"events\":[{\"ts\":1,\"kind\":\"a\",\"data\":{\"deep\":[1,2,{\"x\":\"]}\"}]}},{\"ts\":2},3,{\"kind\":\"only\"}],"
+    "\"big\":{\"a\":[1,2,3],\"s\":\"\\u0041\"},\"a/b\":true,\"m~n\":null,\"n\":1.5}";
+
+// text parsed with the paths, or a null value on an error
+static Json project(const std::vector<std::string>& paths, const std::string& str = text, uint32_t flags = jslite::PARSE_DEFAULT) {
+    JsonProjection projection;
+    for (size_t i = 0; i < paths.size(); ++i) projection.Add(paths[i]);
+
+    JsonStream stream;
+    stream.set_parse_flags(flags);
+    stream.set_projection(&projection);
+    Json json;
+    if (0 != stream.Parse(str, json)) return Json();
+    return json;
+}
+
+static int32_t parse_ret(JsonStream& stream, const char* str) {
+    Json json;
+    return stream.Parse(str, json);
+}
+
+static Json parse(const std::string& str) {
+    JsonStream stream;
+    Json json;
+    stream.Parse(str, json);
+    return json;
+}
+
+// counts the values passed to a handler
+struct KeptCounter : public jslite::JsonHandler {
+    KeptCounter() : values(0), keys(0) {}
+    bool Null() { ++values; return true; }
+    bool Boolean(bool) { ++values; return true; }
+    bool Integer(int64_t) { ++values; return true; }
+    bool Real(double) { ++values; return true; }
+    bool String(const jslite::StringRef&) { ++values; return true; }
+    bool Key(const jslite::StringRef&) { ++keys; return true; }
+    size_t values;
+    size_t keys;
+};
+
+int test_projection_paths() {
+    std::vector<std::string> paths;
+    paths.push_back("/user/id");
+    paths.push_back("/events/*/ts");
+    // containers on the way are kept, a scalar where the path goes on is not
+    EXPECT_EQ(parse("{\"user\":{\"id\":7},\"events\":[{\"ts\":1},{\"ts\":2},{}]}"), project(paths));
+
+    paths.assign(1, "");
+    EXPECT_EQ(parse(text), project(paths));
+    paths.assign(1, "/user");
+    paths.push_back("/user/id");
+    EXPECT_EQ(parse("{\"user\":{\"id\":7,\"name\":\"a \\\"b\\\"\",\"tags\":[\"x\"]}}"), project(paths));
+
+    // a member found by its name has the paths of * too
+    paths.assign(1, "/*/id");
+    paths.push_back("/user/name");
+    paths.push_back("/n");
+    EXPECT_EQ(parse("{\"user\":{\"id\":7,\"name\":\"a \\\"b\\\"\"},\"events\":[],\"big\":{},\"n\":1.5}"), project(paths));
+    paths.assign(1, "/user/name");
+    paths.push_back("/*/id");
+    EXPECT_EQ(parse("{\"user\":{\"id\":7,\"name\":\"a \\\"b\\\"\"},\"events\":[],\"big\":{}}"), project(paths));
+
+    paths.assign(1, "/events/1");
+    paths.push_back("/events/0/data/deep/2");
+    EXPECT_EQ(parse("{\"events\":[{\"data\":{\"deep\":[{\"x\":\"]}\"}]}},{\"ts\":2}]}"), project(paths));
+    paths.assign(1, "/a~1b");
+    paths.push_back("/m~0n");
+    paths.push_back("/big/s");
+    EXPECT_EQ(parse("{\"big\":{\"s\":\"A\"},\"a/b\":true,\"m~n\":null}"), project(paths));
+    paths.assign(1, "/none");
+    EXPECT_EQ(Json::Object(), project(paths).object());
+    EXPECT_EQ((size_t)0, project(paths).size());
+
+    JsonProjection projection;
+    EXPECT_TRUE(projection.empty());
+    EXPECT_EQ((int32_t)jslite::ERR_VALUE, projection.Add("user"));
+    EXPECT_EQ((int32_t)jslite::ERR_VALUE, projection.Add("/a~2"));
+    EXPECT_EQ((int32_t)jslite::ERR_VALUE, projection.Add("/a~"));
+    EXPECT_TRUE(projection.empty());
+    EXPECT_EQ(0, projection.Add("/events/01"));
+    EXPECT_TRUE(NULL == projection.root().Find(jslite::StringRef("events", 6))->Find(1));
+
+    return 0;
+}
+
+int test_projection_skip() {
+    std::vector<std::string> paths(1, "/keep");
+
+    // skipped strings are not unescaped, nor numbers converted
+    EXPECT_EQ(parse("{\"keep\":1}"), project(paths, "{\"skip\":\"\\q\",\"keep\":1,\"more\":[1e999999,\"\\uZZZZ\"]}"));
+    JsonStream stream;
+    Json json;
+    EXPECT_EQ((int32_t)jslite::ERR_ESC_CHAR, stream.Parse("{\"skip\":\"\\q\",\"keep\":1}", json));
+
+    // but the brackets of a skipped value must end
+    JsonProjection projection;
+    projection.Add("/keep");
+    stream.set_projection(&projection);
+    EXPECT_EQ((int32_t)jslite::ERR_VALUE, parse_ret(stream, "{\"skip\":[1,{\"a\":2}"));
+    EXPECT_EQ((int32_t)jslite::ERR_VALUE, parse_ret(stream, "{\"skip\":\"abc"));
+    EXPECT_EQ((int32_t)jslite::ERR_OBJECT_END, parse_ret(stream, "{\"skip\":[1] \"keep\":1}"));
+    EXPECT_EQ((int32_t)jslite::ERR_OBJECT_SEP, parse_ret(stream, "{\"skip\" [1]}"));
+    EXPECT_EQ((int32_t)jslite::ERR_ARRAY_END, parse_ret(stream, "[{\"skip\":1} 2]"));
+
+    // skipped arrays are not counted ahead for the ones kept
+    paths.assign(1, "/b");
+    const char *arrays = "{\"a\":[1,2,3,4,5,6,7,8,9],\"b\":[1,[2,3]],\"c\":[]}";
+    EXPECT_EQ(parse("{\"b\":[1,[2,3]]}"), project(paths, arrays, jslite::PARSE_PRESIZE_ARRAYS));
+    EXPECT_EQ(2, project(paths, arrays, jslite::PARSE_PRESIZE_ARRAYS)["b"].capacity());
+
+    // views and lazy numbers of the values kept
+    paths.assign(1, "/user/name");
+    paths.push_back("/n");
+    const std::string str(text); // the views point into it
+    Json lazy = project(paths, str, jslite::PARSE_ZERO_COPY | jslite::PARSE_LAZY_NUMBERS);
+    EXPECT_EQ("a \"b\"", lazy["user"]["name"].string());
+    EXPECT_EQ(1.5, lazy["n"].real());
+
+    // a handler sees only the values kept
+    KeptCounter counter;
+    stream.Parse(text, counter);
+    EXPECT_EQ((size_t)0, counter.values);
+    projection.Add("/events/*/ts");
+    stream.Parse(text, counter);
+    EXPECT_EQ((size_t)2, counter.values);
+    EXPECT_EQ((size_t)3, counter.keys);
+
+    // into a document, and line by line
+    jslite::JsonDocument doc;
+    projection.clear();
+    projection.Add("/id");
+    EXPECT_EQ(0, stream.Parse("{\"name\":\"x\",\"id\":3}", doc));
+    EXPECT_EQ(parse("{\"id\":3}"), doc.root());
+
+    jslite::JsonLineReader reader;
+    reader.set_projection(&projection);
+    reader.Reset("{\"id\":1,\"a\":[]}\n{\"b\":{},\"id\":2}\n");
+    EXPECT_EQ(0, reader.Next(json));
+    EXPECT_EQ(parse("{\"id\":1}"), json);
+    EXPECT_EQ(0, reader.Next(doc));
+    EXPECT_EQ(parse("{\"id\":2}"), doc.root());
+
+    return 0;
+}
+
+int test_json_projection(int argc, char* argv[]) {
+    EXPECT_EQ(0, test_projection_paths());
+    EXPECT_EQ(0, test_projection_skip());
+
+    LOG("ok");
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "jtest.hpp"
+#include "json_push.hpp"
+#include "json_stream.hpp"
+#include "json_document.hpp"
+
+#include <stdlib.h>
+
+static const char *texts[] = {
+    "{ \"name\" : \"push\\\"ed \\u00e9\\\\\", \"list\": [1, -2.5e+3, true, false, null, [], {}],\n"
+    "  // a comment\n \"nested\": {\"a\": [[1, 2], {\"b\": \"c\"}], \"long\": \"0123456789abcdefghij\"} /* end */ }",
+    "[12345678901234567890, 0.1, \"\", \"\\\\\\\\\", \"x\\ny\", 1e-3]",
+    "\"a string alone\"",
+    "  -12.5e1  ",
+    "true",
+};
+
+// the same value for any split of the text
+int test_push_chunks() {
+    for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); ++t) {
+        const std::string text(texts[t]);
+        jslite::JsonStream stream;
+        stream << text;
+        jslite::Json expected;
+        EXPECT_TRUE(0 == stream.Parse(expected));
+
+        for (size_t size = 1; size <= text.size(); ++size) {
+            jslite::Json json;
+            jslite::JsonPushParser parser(json);
+            int32_t ret = jslite::PUSH_MORE;
+            for (size_t pos = 0; pos < text.size() && jslite::PUSH_MORE == ret; pos += size) {
+                // each chunk in its own buffer, so nothing is read past it
+                const std::string chunk(text, pos, size);
+                ret = parser.Feed(chunk);
+            }
+            if (jslite::PUSH_MORE == ret) ret = parser.Finish();
+            if (0 != ret || !(expected == json)) {
+                LOG("chunks of " << size << " of " << text << " are " << ret);
+                return 1;
+            }
+        }
+    }
+
+    srand(20150118);
+    const std::string text(texts[0]);
+    jslite::Json expected;
+    jslite::JsonStream stream;
+    stream << text;
+    stream.Parse(expected);
+    for (int n = 0; n < 500; ++n) {
+        jslite::JsonDocument doc;
+        jslite::JsonPushParser parser(doc);
+        int32_t ret = jslite::PUSH_MORE;
+        for (size_t pos = 0, size = 0; pos < text.size(); pos += size) {
+            size = 1 + rand() % 12;
+            ret = parser.Feed(text.data() + pos, std::min(size, text.size() - pos));
+        }
+        EXPECT_EQ(0, ret);
+        EXPECT_EQ(text.size(), parser.offset());
+        EXPECT_EQ(expected, doc.root());
+    }
+
+    return 0;
+}
+
+int test_push_errors() {
+    const struct {
+        const char *text;
+        int32_t     err;
+    } cases[] = {
+        { "[1,2,3", jslite::ERR_ARRAY_END },
+        { "[1,2,", jslite::ERR_VALUE },
+        { "\"str ", jslite::ERR_VALUE },
+        { "{\"a\" 1}", jslite::ERR_OBJECT_SEP },
+        { "{\"a\":1 \"b\":2}", jslite::ERR_OBJECT_END },
+        { "{1:2}", jslite::ERR_OBJECT_KEY },
+        { "[1, 2 3]", jslite::ERR_ARRAY_END },
+        { "[01]", jslite::ERR_NUMBER },
+        { "\"\\x\"", jslite::ERR_ESC_CHAR },
+        { "", jslite::ERR_VALUE },
+        { "[tru]", jslite::ERR_VALUE },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        jslite::JsonStream stream;
+        stream << cases[i].text;
+        jslite::Json json;
+        EXPECT_EQ(cases[i].err, stream.Parse(json));
+
+        const std::string text(cases[i].text);
+        for (size_t size = 1; size <= text.size() + 1; ++size) {
+            jslite::JsonPushParser parser(json);
+            int32_t ret = jslite::PUSH_MORE;
+            for (size_t pos = 0; pos < text.size() && jslite::PUSH_MORE == ret; pos += size) {
+                ret = parser.Feed(std::string(text, pos, size));
+            }
+            if (jslite::PUSH_MORE == ret) ret = parser.Finish();
+            EXPECT_EQ(cases[i].err, ret);
+            EXPECT_EQ(ret, parser.Feed("]"));
+        }
+    }
+
+    jslite::Json json;
+    jslite::JsonPushParser parser(json);
+    parser.set_max_depth(3);
+    EXPECT_EQ((int32_t)jslite::ERR_OVERFLOW, parser.Feed("[[[[1]]]]"));
+
+    return 0;
+}
+
+int test_push_budget() {
+    std::string text("[");
+    for (int i = 0; i < 1000; ++i) text += (i ? ", " : "") + std::to_string(i);
+    text += "] trailing";
+
+    jslite::Json json;
+    jslite::JsonPushParser parser(json);
+    parser.set_budget(64);
+
+    int pauses = 0;
+    int32_t ret = parser.Feed(text);
+    while (jslite::PUSH_PAUSED == ret) {
+        ++pauses;
+        EXPECT_TRUE(parser.buffered() > 0);
+        ret = parser.Resume();
+    }
+    EXPECT_EQ(0, ret);
+    EXPECT_TRUE(pauses > 50);
+    EXPECT_EQ((size_t)1000, json.size());
+    EXPECT_EQ(999, json[(size_t)999].integer());
+    EXPECT_EQ(text.find(']') + 1, parser.offset());
+
+    // a time budget pauses too, and data fed at a pause goes after the rest
+    parser.Reset(json);
+    parser.set_budget(0, 1);
+    const size_t half = text.size() / 2;
+    ret = parser.Feed(text.data(), half);
+    while (jslite::PUSH_PAUSED == ret) ret = parser.Resume();
+    EXPECT_EQ((int32_t)jslite::PUSH_MORE, ret);
+    ret = parser.Feed(text.data() + half, text.size() - half);
+    while (jslite::PUSH_PAUSED == ret) ret = parser.Resume();
+    EXPECT_EQ(0, ret);
+    EXPECT_EQ((size_t)1000, json.size());
+
+    // the rest of a paused chunk is copied when data is fed before it is used
+    parser.Reset(json);
+    parser.set_budget(64);
+    std::string first(text, 0, half);
+    EXPECT_EQ((int32_t)jslite::PUSH_PAUSED, parser.Feed(first));
+    ret = parser.Feed(text.data() + half, text.size() - half);
+    first.assign(first.size(), ' ');
+    while (jslite::PUSH_PAUSED == ret) ret = parser.Resume();
+    EXPECT_EQ(0, ret);
+    EXPECT_EQ((size_t)1000, json.size());
+    EXPECT_EQ(999, json[(size_t)999].integer());
+    EXPECT_EQ(text.find(']') + 1, parser.offset());
+
+    return 0;
+}
+
+int test_json_push(int argc, char* argv[]) {
+    EXPECT_EQ(0, test_push_chunks());
+    EXPECT_EQ(0, test_push_errors());
+    EXPECT_EQ(0, test_push_budget());
+
+    LOG("ok");
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "jtest.hpp"
+#include "json_reader.hpp"
+#include "json_stream.hpp"
+
+using jslite::JsonReader;
+using jslite::JsonTokenzier;
+using jslite::StringRef;
+
+struct Order {
+    int64_t     id;
+    uint64_t    mask;
+    double      price;
+    bool        open;
+    std::string name;
+};
+
+// reads the fields it knows and skips the others
+static int32_t decode(const std::string& text, Order& order) {
+    JsonReader reader(text);
+    if (JsonTokenzier::TK_OBJ_BEGIN != reader.NextToken()) return jslite::ERR_VALUE;
+
+    int32_t ret = 0;
+    StringRef key, str;
+    while (JsonTokenzier::TK_STRING == reader.NextToken()) {
+        if (0 != (ret = reader.GetStringView(key))) return ret;
+        if (JsonTokenzier::TK_COLON != reader.NextToken()) return jslite::ERR_OBJECT_SEP;
+        reader.NextToken();
+
+        if (key == "id") ret = reader.GetInt64(order.id);
+        else if (key == "mask") ret = reader.GetUInt64(order.mask);
+        else if (key == "price") ret = reader.GetDouble(order.price);
+        else if (key == "open") ret = reader.GetBool(order.open);
+        else if (key == "name") {
+            ret = reader.GetStringView(str);
+            order.name.assign(str.data, str.size);
+        } else {
+            ret = reader.SkipValue();
+        }
+        if (0 != ret) return ret;
+
+        if (JsonTokenzier::TK_COMMA != reader.NextToken()) break;
+    }
+    if (JsonTokenzier::TK_OBJ_END != reader.type()) return jslite::ERR_OBJECT_END;
+    return (JsonTokenzier::TK_EOF == reader.NextToken() ? 0 : jslite::ERR_VALUE);
+}
+
+int test_reader_decode() {
+    Order order;
+    EXPECT_EQ(0, decode("{\"id\": -42, \"tags\": [\"a\", {\"b\": [1, [2]]}, \"]\"], \"price\": 12.5,\n"
+                        " // note\n \"extra\": {\"x\": null}, \"name\": \"a \\\"quoted\\\" \\u00e9\","
+                        " \"mask\": 18446744073709551615, \"open\": true}", order));
+    EXPECT_EQ(-42, order.id);
+    EXPECT_EQ(18446744073709551615ULL, order.mask);
+    EXPECT_EQ(12.5, order.price);
+    EXPECT_TRUE(order.open);
+    EXPECT_EQ("a \"quoted\" \xC3\xA9", order.name);
+
+    EXPECT_EQ(jslite::ERR_JSON_TYPE, decode("{\"id\": \"1\"}", order));
+    EXPECT_EQ(jslite::ERR_NUMBER, decode("{\"id\": 1.5}", order));
+    EXPECT_EQ(jslite::ERR_OVERFLOW, decode("{\"id\": 9223372036854775808}", order));
+    EXPECT_EQ(0, decode("{\"id\": 1000000000}", order));
+    EXPECT_EQ(1000000000, order.id);
+    EXPECT_EQ(0, decode("{\"id\": 5000000000}", order));
+    EXPECT_EQ(5000000000LL, order.id);
+    EXPECT_EQ(0, decode("{\"id\": 9223372036854775807}", order));
+    EXPECT_EQ(INT64_MAX, order.id);
+    EXPECT_EQ(jslite::ERR_OVERFLOW, decode("{\"mask\": -1}", order));
+    EXPECT_EQ(jslite::ERR_NUMBER, decode("{\"price\": 01}", order));
+    EXPECT_EQ(jslite::ERR_ESC_CHAR, decode("{\"name\": \"\\x\"}", order));
+    EXPECT_EQ(jslite::ERR_VALUE, decode("{\"other\": [1, {]", order));
+    EXPECT_EQ(jslite::ERR_VALUE, decode("{\"other\": }", order));
+    EXPECT_EQ(jslite::ERR_OBJECT_END, decode("{\"id\": 1 \"a\": 2}", order));
+
+    return 0;
+}
+
+int test_reader_tokens() {
+    const std::string text("[1, \"two\", /* three */ 3.5, null]");
+    JsonReader reader(text);
+    EXPECT_EQ(JsonTokenzier::TK_NONE, reader.type());
+    EXPECT_EQ(JsonTokenzier::TK_ARR_BEGIN, reader.NextToken());
+
+    int64_t i = 0;
+    double d = 0;
+    StringRef str;
+    EXPECT_EQ(JsonTokenzier::TK_INTEGER, reader.NextToken());
+    EXPECT_EQ(0, reader.GetInt64(i));
+    EXPECT_EQ(0, reader.GetDouble(d));
+    EXPECT_EQ(1, i);
+    EXPECT_EQ(1.0, d);
+    EXPECT_EQ(JsonTokenzier::TK_COMMA, reader.NextToken());
+    EXPECT_EQ(JsonTokenzier::TK_STRING, reader.NextToken());
+    EXPECT_EQ(0, reader.GetStringView(str));
+    // no escapes, so the view is in the text
+    EXPECT_TRUE(str.data == text.data() + 5);
+    EXPECT_TRUE(str == "two");
+    EXPECT_EQ(jslite::ERR_JSON_TYPE, reader.GetDouble(d));
+    EXPECT_EQ(JsonTokenzier::TK_COMMA, reader.NextToken());
+    EXPECT_EQ(JsonTokenzier::TK_REAL, reader.NextToken());
+    EXPECT_EQ(0, reader.GetDouble(d));
+    EXPECT_EQ(3.5, d);
+    EXPECT_EQ(JsonTokenzier::TK_COMMA, reader.NextToken());
+    EXPECT_EQ(JsonTokenzier::TK_NULL, reader.NextToken());
+    EXPECT_TRUE(reader.IsNull());
+    EXPECT_EQ(JsonTokenzier::TK_ARR_END, reader.NextToken());
+    EXPECT_EQ(JsonTokenzier::TK_EOF, reader.NextToken());
+    EXPECT_EQ(JsonTokenzier::TK_EOF, reader.NextToken());
+
+    // a whole value skipped at once
+    JsonReader skip(StringRef("[[1, {\"a\": [2]}], 3]"));
+    EXPECT_EQ(JsonTokenzier::TK_ARR_BEGIN, skip.NextToken());
+    EXPECT_EQ(JsonTokenzier::TK_ARR_BEGIN, skip.NextToken());
+    EXPECT_EQ(0, skip.SkipValue());
+    EXPECT_EQ(JsonTokenzier::TK_ARR_END, skip.type());
+    EXPECT_EQ(JsonTokenzier::TK_COMMA, skip.NextToken());
+    EXPECT_EQ(JsonTokenzier::TK_INTEGER, skip.NextToken());
+    EXPECT_EQ(0, skip.SkipValue());
+    EXPECT_EQ(JsonTokenzier::TK_INTEGER, skip.type());
+
+    // a copy reads its own tokens
+    JsonReader first(StringRef("[7, 8]"));
+    first.NextToken();
+    first.NextToken();
+    JsonReader copied(first);
+    EXPECT_EQ(JsonTokenzier::TK_COMMA, first.NextToken());
+    EXPECT_EQ(JsonTokenzier::TK_INTEGER, copied.type());
+    EXPECT_EQ(0, copied.GetInt64(i));
+    EXPECT_EQ(7, i);
+    EXPECT_EQ(JsonTokenzier::TK_COMMA, copied.NextToken());
+
+    return 0;
+}
+
+int test_json_reader(int argc, char* argv[]) {
+    EXPECT_EQ(0, test_reader_decode());
+    EXPECT_EQ(0, test_reader_tokens());
+
+    LOG("ok");
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "jtest.hpp"
+#include "json_sax.hpp"
+#include "json_push.hpp"
+#include "json_stream.hpp"
+
+#include <sstream>
+
+// writes the events as text
+class EventLog : public jslite::JsonHandler {
+public:
+    EventLog() : stop_(0) {}
+    explicit EventLog(int stop) : stop_(stop) {}
+
+    bool Null() { return Add("null"); }
+    bool Boolean(bool value) { return Add(value ? "true" : "false"); }
+    bool Integer(int64_t value) { return Add("i" + std::to_string(value)); }
+    bool UInteger(uint64_t value) { return Add("u" + std::to_string(value)); }
+    bool Real(double value) { std::ostringstream oss; oss << "r" << value; return Add(oss.str()); }
+    bool String(const jslite::StringRef& str) { return Add("s" + std::string(str.data, str.size)); }
+    bool StartObject() { return Add("{"); }
+    bool Key(const jslite::StringRef& key) { return Add("k" + std::string(key.data, key.size)); }
+    bool EndObject(size_t members) { return Add("}" + std::to_string(members)); }
+    bool StartArray() { return Add("["); }
+    bool EndArray(size_t elements) { return Add("]" + std::to_string(elements)); }
+
+    std::string log;
+
+private:
+    // the stop_-th event fails
+    bool Add(const std::string& event) {
+        if (!log.empty()) log += " ";
+        log += event;
+        return 0 != --stop_;
+    }
+
+    int stop_;
+};
+
+// a handler that is not a JsonHandler, called without virtual functions
+struct Counter {
+    Counter() : values(0), depth(0), max_depth(0) {}
+
+    bool Null() { ++values; return true; }
+    bool Boolean(bool) { ++values; return true; }
+    bool Integer(int64_t) { ++values; return true; }
+    bool UInteger(uint64_t) { ++values; return true; }
+    bool Real(double) { ++values; return true; }
+    bool String(const jslite::StringRef&) { ++values; return true; }
+    bool RawString(const jslite::StringRef&, bool) { ++values; return true; }
+    bool Number(const jslite::StringRef&) { ++values; return true; }
+    bool Key(const jslite::StringRef&) { return true; }
+    bool StartObject() { return Open(); }
+    bool EndObject(size_t) { --depth; return true; }
+    bool StartArray() { return Open(); }
+    bool EndArray(size_t) { --depth; return true; }
+
+    bool Open() {
+        ++values;
+        if (++depth > max_depth) max_depth = depth;
+        return true;
+    }
+
+    size_t values;
+    size_t depth;
+    size_t max_depth;
+};
+
+static const char *text =
+    "{\"name\":\"a\\\"b\", \"list\":[1, -2, 2.5, 18446744073709551615, true, false, null, [], {}],\n"
+    " /* c */ \"o\":{\"x\":\"\"}}";
+
+static const char *events =
+    "{ kname sa\"b klist [ i1 i-2 r2.5 u18446744073709551615 true false null [ ]0 { }0 ]9 ko { kx s }1 }3";
+
+int test_sax_events() {
+    jslite::JsonStream stream;
+    stream << text;
+    EventLog log;
+    EXPECT_EQ(0, stream.Parse(log));
+    EXPECT_EQ(events, log.log);
+
+    // the same through the template without virtual calls
+    Counter counter;
+    jslite::JsonSaxParser<Counter> parser(counter);
+    const std::string str(text);
+    EXPECT_EQ(0, parser.Parse(str.data(), str.data() + str.size()));
+    EXPECT_EQ(14, counter.values);
+    EXPECT_EQ(3, counter.max_depth);
+    EXPECT_EQ(0, counter.depth);
+
+    // and from a push parser, one byte at a time
+    EventLog pushed;
+    jslite::JsonPushParser push(pushed);
+    for (size_t i = 0; i < str.size(); ++i) push.Feed(str.data() + i, 1);
+    EXPECT_EQ(0, push.status());
+    EXPECT_EQ(events, pushed.log);
+
+    return 0;
+}
+
+// the defaults of RawString() and Number() give the same events
+int test_sax_views() {
+    const std::string str(text);
+
+    EventLog log;
+    jslite::JsonSaxParser<jslite::JsonHandler> parser(log, jslite::PARSE_ZERO_COPY | jslite::PARSE_LAZY_NUMBERS);
+    EXPECT_EQ(0, parser.Parse(str.data(), str.data() + str.size()));
+    EXPECT_EQ(events, log.log);
+
+    // the views of a tree refer to the text
+    jslite::Json json;
+    jslite::JsonDomBuilder builder(json);
+    jslite::JsonSaxParser<jslite::JsonDomBuilder> views(builder, jslite::PARSE_ZERO_COPY | jslite::PARSE_LAZY_NUMBERS);
+    EXPECT_EQ(0, views.Parse(str.data(), str.data() + str.size()));
+    EXPECT_EQ("a\"b", json["name"].string());
+    EXPECT_EQ(2.5, json["list"][2].real());
+    EXPECT_EQ(9, json["list"].size());
+
+    return 0;
+}
+
+int test_sax_cancel() {
+    const std::string str(text);
+    for (int stop = 1; stop <= 22; ++stop) {
+        EventLog log(stop);
+        jslite::JsonSaxParser<EventLog> parser(log);
+        EXPECT_EQ(jslite::ERR_CANCELED, parser.Parse(str.data(), str.data() + str.size()));
+
+        EventLog pushed(stop);
+        jslite::JsonPushParser push(pushed);
+        EXPECT_EQ(jslite::ERR_CANCELED, push.Feed(str));
+        EXPECT_EQ(log.log, pushed.log);
+    }
+
+    // errors of the text are reported as usual
+    jslite::JsonStream stream;
+    stream << "[1, 2";
+    EventLog log;
+    EXPECT_EQ(jslite::ERR_ARRAY_END, stream.Parse(log));
+    EXPECT_EQ("[ i1 i2", log.log);
+
+    Counter counter;
+    jslite::JsonSaxParser<Counter> parser(counter);
+    parser.set_max_depth(3);
+    const std::string deep("[[[[1]]]]");
+    EXPECT_EQ(jslite::ERR_OVERFLOW, parser.Parse(deep.data(), deep.data() + deep.size()));
+
+    return 0;
+}
+
+// far deeper than the call stack would allow
+int test_sax_depth() {
+    const size_t depth = 1000000;
+    std::string text(depth, '[');
+    text += "{\"a\":[1]}";
+    text.append(depth, ']');
+
+    Counter counter;
+    jslite::JsonSaxParser<Counter> parser(counter);
+    EXPECT_EQ((int32_t)jslite::ERR_OVERFLOW, parser.Parse(text.data(), text.data() + text.size()));
+
+    counter = Counter();
+    parser.set_max_depth(depth + 2);
+    EXPECT_EQ(0, parser.Parse(text.data(), text.data() + text.size()));
+    EXPECT_EQ(depth + 3, counter.values);
+    EXPECT_EQ(depth + 2, counter.max_depth);
+    EXPECT_EQ(0, counter.depth);
+
+    // the limit of a stream
+    jslite::JsonStream stream;
+    stream.set_max_depth(2);
+    jslite::Json json;
+    EXPECT_EQ(0, stream.Parse("[{\"a\":1}, []]", json));
+    EXPECT_EQ((int32_t)jslite::ERR_OVERFLOW, stream.Parse("[{\"a\":[]}]", json));
+
+    return 0;
+}
+
+int test_json_sax(int argc, char* argv[]) {
+    EXPECT_EQ(0, test_sax_events());
+    EXPECT_EQ(0, test_sax_views());
+    EXPECT_EQ(0, test_sax_cancel());
+    EXPECT_EQ(0, test_sax_depth());
+
+    LOG("ok");
+
+    return 0;
+}
@@ -0,0 +1,311 @@
+#include "jtest.hpp"
+#include "json_simd.hpp"
+#include "json_tokenizer.hpp"
+#include "json_stream.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using jslite::JsonTokenzier;
+
+struct TokenPos {
+    int       type;
+    ptrdiff_t begin;
+    ptrdiff_t end;
+    bool operator == (const TokenPos& o) const { return type == o.type && begin == o.begin && end == o.end; }
+};
+
+static std::vector<TokenPos> tokens_of(const std::string& text, const jslite::JsonStructuralIndex* index) {
+    JsonTokenzier tokenizer(text.c_str(), text.c_str() + text.size());
+    if (index) tokenizer.set_index(index->data(), index->size());
+
+    std::vector<TokenPos> tokens;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        const JsonTokenzier::Token &token = tokenizer.NextToken();
+        TokenPos pos = { token.type, token.begin - text.c_str(), token.end - text.c_str() };
+        tokens.push_back(pos);
+        if (JsonTokenzier::TK_EOF == token.type) break;
+    }
+    return tokens;
+}
+
+// tokens with the index of each simd level are the same as without
+static int same_tokens(const std::string& text, bool indexed) {
+    const std::vector<TokenPos> expected = tokens_of(text, NULL);
+
+    for (int level = jslite::SIMD_SCALAR; level <= jslite::simd_level(); ++level) {
+        jslite::JsonStructuralIndex index;
+        if (indexed != index.Build(text.c_str(), text.c_str() + text.size(), (jslite::SimdLevel)level)) {
+            LOG("level " << level << " index of " << text);
+            return 1;
+        }
+        if (indexed && !(tokens_of(text, &index) == expected)) {
+            LOG("level " << level << " tokens of " << text);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int test_simd_tokens() {
+    std::string escapes("{\"k\":\"");
+    for (int i = 0; i < 70; ++i) escapes += (i % 7 ? "a" : "\\\\\\\"");
+    escapes += "\\\\\", \"n\":[1,2]}";
+
+    std::string blob("[\"");
+    blob.append(200, 'x');
+    blob += "\",  true  ,null,\n-1.5e3]";
+
+    const char *valid[] = {
+        "", "   ", "{}", "[]", "\"\"", "\"a\\\\\"", "{ \"a\" : [ 1, 2.5, -3e+2, true, false, null ] }",
+        "{\"k\\\"ey\":\"v\\\\\",\"x\":{\"y\":[[],{}]}}\n",
+        "12abc", "nulll", "tru", "1 2\t3\r\n\v\f4", "\"a\"x\"b\"", "[1,]", "{:}", "@#$%", "\xEA\xB0\x80 1",
+        "[1\xA0 2]", "tru\xE9\x85 1", // bytes above 0x7F after a scalar are not spaces
+    };
+    for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); ++i) {
+        EXPECT_EQ(0, same_tokens(valid[i], true));
+    }
+    EXPECT_EQ(0, same_tokens(escapes, true));
+    EXPECT_EQ(0, same_tokens(blob, true));
+
+    // left to the scalar tokenizer
+    const char *scalar[] = { "[1, // note\n 2]", "/* c */ 1", "\"open", "\\\"a\"", "{\"a\":/}" };
+    for (size_t i = 0; i < sizeof(scalar) / sizeof(scalar[0]); ++i) {
+        EXPECT_EQ(0, same_tokens(scalar[i], false));
+    }
+    EXPECT_EQ(0, same_tokens(std::string("[1,\0 2]", 7), false));
+
+    return 0;
+}
+
+int test_simd_random() {
+    const char alphabet[] = "{}[]:,\"\\ \n\t1.e-tnaux";
+    srand(20150112);
+    for (int n = 0; n < 3000; ++n) {
+        std::string text;
+        size_t len = rand() % 300;
+        for (size_t i = 0; i < len; ++i) text += alphabet[rand() % (sizeof(alphabet) - 1)];
+
+        jslite::JsonStructuralIndex index;
+        bool indexed = index.Build(text.c_str(), text.c_str() + text.size(), jslite::SIMD_SCALAR);
+        if (0 != same_tokens(text, indexed)) return 1;
+    }
+
+    // mostly well formed texts, so that most of them are indexed
+    const char *pieces[] = {
+        "{", "}", "[", "]", ":", ",", " ", "\n  ", "1", "-2.5e3", "true", "nul", "x",
+        "\"abc\"", "\"a\\\"b\"", "\"\\\\\"", "\"\\u00e9 \\\\\\\"\"",
+        "\"a string a bit longer than the sixty four bytes of one block of the index\"",
+    };
+    const size_t count = sizeof(pieces) / sizeof(pieces[0]);
+    int indexed = 0;
+    for (int n = 0; n < 3000; ++n) {
+        std::string text;
+        size_t len = rand() % 80;
+        for (size_t i = 0; i < len; ++i) text += pieces[rand() % count];
+        if (0 == rand() % 10) text.insert(rand() % (text.size() + 1), "\"");
+
+        jslite::JsonStructuralIndex index;
+        bool built = index.Build(text.c_str(), text.c_str() + text.size(), jslite::SIMD_SCALAR);
+        indexed += built;
+        if (0 != same_tokens(text, built)) return 1;
+    }
+    EXPECT_TRUE(indexed > 2000);
+
+    return 0;
+}
+
+int test_simd_scan() {
+    const char alphabet[] = " \t\n\r\v\fa\"\\\x01\x1F\x7F\x80\xFF";
+    srand(20150113);
+    for (int n = 0; n < 2000; ++n) {
+        // long runs of one character with a few others in between
+        std::string text(rand() % 200, alphabet[rand() % (sizeof(alphabet) - 1)]);
+        for (int i = rand() % 4; i > 0 && !text.empty(); --i) {
+            text[rand() % text.size()] = alphabet[rand() % (sizeof(alphabet) - 1)];
+        }
+
+        const char *end = text.c_str() + text.size();
+        for (const char *it = text.c_str(); it <= end; ++it) {
+            const char *stop = it, *space = it;
+            while (stop != end && '"' != *stop && '\\' != *stop && (uint8_t)*stop >= 0x20) ++stop;
+            while (space != end && isspace((uint8_t)*space)) ++space;
+            if (stop != jslite::ScanString(it, end) || space != jslite::SkipSpaces(it, end)) {
+                LOG("scan of " << text << " from " << (it - text.c_str()));
+                return 1;
+            }
+        }
+    }
+
+    std::string text("\"");
+    text.append(100, 'x');
+    text += "\\\"";
+    text.append(100, ' ');
+    text += "\"";
+    JsonTokenzier tokenizer(text.c_str(), text.c_str() + text.size());
+    EXPECT_EQ(JsonTokenzier::TK_STRING, tokenizer.NextToken().type);
+    EXPECT_EQ(text.size(), (size_t)(tokenizer.CurrentToken().end - text.c_str()));
+    EXPECT_EQ(JsonTokenzier::TK_EOF, tokenizer.NextToken().type);
+
+    return 0;
+}
+
+int test_simd_parse() {
+    std::string text("{\"items\":[");
+    for (int i = 0; i < 100; ++i) {
+        if (i) text += ",";
+        text += "{\"id\":" + std::to_string(i) + ",\"name\":\"item \\\"" + std::to_string(i) + "\\\"\",\"ok\":true}";
+    }
+    text += "], \"total\" : 100 }";
+
+    jslite::JsonStream parser, indexed;
+    indexed.set_parse_flags(jslite::PARSE_STRUCTURAL_INDEX);
+    parser << text;
+    indexed << text;
+
+    jslite::Json expected, json;
+    EXPECT_TRUE(0 == parser.Parse(expected));
+    EXPECT_TRUE(0 == indexed.Parse(json));
+    EXPECT_EQ(expected, json);
+    EXPECT_EQ("item \"42\"", json["items"][42]["name"].string());
+
+    return 0;
+}
+
+int test_simd_split() {
+    // elements with brackets, commas and escapes in strings, at any offset
+    // of a block
+    const char *pieces[] = { "\"],[\"", "\"\\\\\"", "\"\\\"]\"", "[1,{\"a\":[]}]", "{}", "12", " ", "\"x,x\"" };
+    srand(20150123);
+    for (int n = 0; n < 300; ++n) {
+        std::vector<std::string> elements(rand() % 20 + 1);
+        std::string text(rand() % 70, ' ');
+        text += "[";
+        for (size_t i = 0; i < elements.size(); ++i) {
+            for (int j = rand() % 4; j >= 0; --j) elements[i] += pieces[rand() % 8];
+            if (elements[i].find_first_not_of(' ') == std::string::npos) elements[i] += "0";
+            if (i) text += ",";
+            text += elements[i];
+        }
+        text += "]\n";
+
+        for (int level = jslite::SIMD_SCALAR; level <= jslite::simd_level(); ++level) {
+            std::vector<jslite::JsonArraySpan> spans;
+            bool split = jslite::SplitArray(text.c_str(), text.c_str() + text.size(), 1, spans, (jslite::SimdLevel)level);
+            bool same = split && spans.size() == elements.size();
+            for (size_t i = 0; same && i < spans.size(); ++i) {
+                same = (i == spans[i].first && 1 == spans[i].count &&
+                        elements[i] == std::string(spans[i].begin, spans[i].end));
+            }
+            if (!same) {
+                LOG("level " << level << " split of " << text);
+                return 1;
+            }
+        }
+    }
+
+    std::vector<jslite::JsonArraySpan> spans;
+    std::string text("[1,2,3,4]");
+    EXPECT_TRUE(jslite::SplitArray(text.c_str(), text.c_str() + text.size(), 3, spans));
+    EXPECT_EQ((size_t)2, spans.size());
+    EXPECT_EQ((size_t)2, spans[1].first);
+    EXPECT_EQ("3,4", std::string(spans[1].begin, spans[1].end));
+
+    const char *texts[] = { "[ ]", "{\"a\":1}", "[1] x", "[1,/*,*/2]", "[\"a]", "[1}", "[[1]" };
+    const bool splits[] = { true, false, false, false, false, false, false };
+    for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); ++i) {
+        text = texts[i];
+        EXPECT_EQ(splits[i], jslite::SplitArray(text.c_str(), text.c_str() + text.size(), 1, spans));
+    }
+    EXPECT_TRUE(spans.empty());
+
+    return 0;
+}
+
+// containers nested depth times with pieces around each
+static std::string nested_value(int depth) {
+    const char *pieces[] = { "\"]}\"", "\"\\\\\"", "\"\\\"]\"", "[1,{\"a\":[]}]", "{}", "12", " ", "\"[{x\"" };
+    std::string value = (rand() % 2 ? "[" : "{");
+    for (int j = rand() % 4; j >= 0; --j) value += pieces[rand() % 8];
+    if (depth) value += nested_value(depth - 1);
+    for (int j = rand() % 4; j >= 0; --j) value += pieces[rand() % 8];
+    return value + ('[' == value[0] ? "]" : "}");
+}
+
+int test_simd_skip() {
+    // at any offset of a block, in one block or over many of them
+    srand(20150125);
+    for (int n = 0; n < 300; ++n) {
+        const std::string value = nested_value(rand() % 30);
+        const std::string text = std::string(rand() % 70, ' ') + value + " ,[1] // ]";
+        const char *begin = text.c_str() + text.find_first_not_of(' ');
+
+        for (int level = jslite::SIMD_SCALAR; level <= jslite::simd_level(); ++level) {
+            if (begin + value.size() != jslite::SkipContainer(begin + 1, text.c_str() + text.size(), (jslite::SimdLevel)level)) {
+                LOG("level " << level << " skip of " << text);
+                return 1;
+            }
+        }
+    }
+
+    const char *texts[] = { "[1,[2]", "[\"]\"", "[1,/*]*/2]", "[1,2\0]" };
+    for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); ++i) {
+        const std::string text(texts[i], 3 == i ? 7 : strlen(texts[i]));
+        EXPECT_TRUE(NULL == jslite::SkipContainer(text.c_str() + 1, text.c_str() + text.size()));
+    }
+
+    // the tokenizer goes on after the value, with comments token by token
+    std::string text("[[1, /* ] */ {\"a\": \"]\"}], 2]");
+    JsonTokenzier tokenizer(text.c_str(), text.c_str() + text.size());
+    EXPECT_TRUE(JsonTokenzier::TK_ARR_BEGIN == tokenizer.NextToken().type);
+    EXPECT_TRUE(JsonTokenzier::TK_ARR_BEGIN == tokenizer.NextToken().type);
+    EXPECT_TRUE(tokenizer.SkipValue());
+    EXPECT_TRUE(JsonTokenzier::TK_ARR_END == tokenizer.CurrentToken().type);
+    EXPECT_EQ(text.find("],"), (size_t)(tokenizer.CurrentToken().begin - text.c_str()));
+    EXPECT_TRUE(JsonTokenzier::TK_COMMA == tokenizer.NextToken().type);
+    EXPECT_FALSE(tokenizer.SkipValue());
+    EXPECT_TRUE(JsonTokenzier::TK_INTEGER == tokenizer.NextToken().type);
+    EXPECT_TRUE(tokenizer.SkipValue());
+    EXPECT_TRUE(JsonTokenzier::TK_ARR_END == tokenizer.NextToken().type);
+
+    text = "{\"a\":[1,2}";
+    tokenizer.Reset(text.c_str(), text.c_str() + text.size());
+    tokenizer.NextToken();
+    EXPECT_FALSE(tokenizer.SkipValue());
+
+    // and from the next position of an index
+    text = "[{\"a\":[1,\"]\"]},{\"b\":{}}, true]";
+    jslite::JsonStructuralIndex index;
+    EXPECT_TRUE(index.Build(text.c_str(), text.c_str() + text.size()));
+    tokenizer.Reset(text.c_str(), text.c_str() + text.size());
+    tokenizer.set_index(index.data(), index.size());
+    EXPECT_TRUE(JsonTokenzier::TK_ARR_BEGIN == tokenizer.NextToken().type);
+    EXPECT_TRUE(JsonTokenzier::TK_OBJ_BEGIN == tokenizer.NextToken().type);
+    EXPECT_TRUE(tokenizer.SkipValue());
+    EXPECT_TRUE(JsonTokenzier::TK_COMMA == tokenizer.NextToken().type);
+    EXPECT_TRUE(JsonTokenzier::TK_OBJ_BEGIN == tokenizer.NextToken().type);
+    EXPECT_TRUE(tokenizer.SkipValue());
+    EXPECT_TRUE(JsonTokenzier::TK_OBJ_END == tokenizer.CurrentToken().type);
+    EXPECT_TRUE(JsonTokenzier::TK_COMMA == tokenizer.NextToken().type);
+    EXPECT_TRUE(JsonTokenzier::TK_TRUE == tokenizer.NextToken().type);
+    EXPECT_TRUE(JsonTokenzier::TK_ARR_END == tokenizer.NextToken().type);
+    EXPECT_TRUE(JsonTokenzier::TK_EOF == tokenizer.NextToken().type);
+
+    return 0;
+}
+
+int test_json_simd(int argc, char* argv[]) {
+    LOG("simd level " << jslite::simd_level());
+
+    EXPECT_EQ(0, test_simd_tokens());
+    EXPECT_EQ(0, test_simd_random());
+    EXPECT_EQ(0, test_simd_scan());
+    EXPECT_EQ(0, test_simd_parse());
+    EXPECT_EQ(0, test_simd_split());
+    EXPECT_EQ(0, test_simd_skip());
+
+    LOG("ok");
+
+    return 0;
+}